@@ -0,0 +1,84 @@
+#pragma once
+
+#include "SpectralAnalyzer.h"
+#include "ThreadPolicy.h"
+
+#include "cinder/Color.h"
+#include "cinder/Exception.h"
+#include "cinder/Filesystem.h"
+#include "cinder/Json.h"
+
+#include <limits>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+//! Shows a shape when the dominant pitch lies in (mMinFreq, mMaxFreq) and is louder than mMinLevel.
+struct PitchTrigger {
+    //! Which of the scene's band positions the shape is drawn at.
+    enum class Slot { LOW, MID, HIGH };
+
+    PitchTrigger()
+        : mSlot( Slot::MID ), mMinFreq( -std::numeric_limits<float>::infinity() ), mMaxFreq( std::numeric_limits<float>::infinity() ), mMinLevel( 10 )
+    {}
+
+    bool matches( float freq, float level ) const   { return freq > mMinFreq && freq < mMaxFreq && level > mMinLevel; }
+
+    std::string     mName;
+    Slot            mSlot;
+    float           mMinFreq, mMaxFreq;     //!< hertz, exclusive
+    float           mMinLevel;              //!< decibels (0 - 100), exclusive
+    ci::ColorA      mColor;
+};
+
+//! Immutable snapshot of every tunable of the analysis and the reactive shapes. A default constructed config
+//! matches the values the app was originally written with.
+struct AnalysisConfig {
+    AnalysisConfig();
+
+    //! Parses and validates \a json. Keys that are missing keep their default, unknown ones are logged and ignored.
+    //! Throws AnalysisConfigExc.
+    static std::shared_ptr<const AnalysisConfig> create( const ci::JsonTree &json );
+
+    //! Largest analysis window the pipeline can hold, frames; configs asking for more are rejected.
+    static const size_t kMaxWindowSize = 8192;
+    //! Lowest minPitch accepted, hertz. The time-domain estimators read 2.5 of its periods from the raw sample tap,
+    //! which is sized for that at up to 192 kHz (see AnalysisPipeline::kRawTapCapacity).
+    static const int    kLowestPitch = 20;
+
+    ci::JsonTree toJson() const;
+
+    //! ~/Documents/InputAnalyzer.json
+    static ci::fs::path getDefaultPath();
+
+    SpectralAnalyzer::Format                        mAnalysis;          //!< the active preset's format
+    std::string                                     mPreset;            //!< empty if "analysis" is used directly
+    std::map<std::string, SpectralAnalyzer::Format> mPresets;
+    float                                           mCentroidFactor;    //!< sample rate divisor of the centroid pitch estimate, 0.745
+    float                                           mReferenceWidth;    //!< bin scale the centroid factor was tuned against, 1024
+    float                                           mPitchThreshold;    //!< decibels a pitch has to exceed to count (readout, first pitch)
+    float                                           mAnalysisRate;      //!< hertz the input is resampled to (e.g. 24000) for the spectrum and the pitch cascade, 0 analyzes at the device rate
+    float                                           mMinPitch, mMaxPitch;   //!< hertz, range the pitch estimators search
+    bool                                            mOctaveCorrection;  //!< move the pitch estimate an octave when the harmonics say so
+    float                                           mTunerReference;    //!< hertz of A4 the tuner reads notes and cents against, 440
+    std::vector<PitchTrigger>                       mTriggers;
+    std::string                                     mInputDevice;       //!< preferred input by name, empty for the system default
+    std::string                                     mBackupInputDevice; //!< used while the preferred one is missing
+    float                                           mMaxFrameRate;      //!< the app's frame rate cap while there is something to show, 60
+    float                                           mIdleFrameRate;     //!< the app's frame rate while the input is silent, 5
+
+    // "threads": { "audio": { "realtime": true, "priority": 80, "cpus": [ 2 ] }, "analysis": ..., "render": ... }
+    ThreadPolicy                                    mAudioThread;       //!< the device callback
+    //! The daemon's analysis loop and the analyzer preparation worker. The app analyzes on its main thread, which
+    //! follows mRenderThread; it warns when this asks for more than the preparation worker can use.
+    ThreadPolicy                                    mAnalysisThread;
+    ThreadPolicy                                    mRenderThread;      //!< the app's main thread, which also runs the analysis step
+};
+
+typedef std::shared_ptr<const AnalysisConfig> AnalysisConfigRef;
+
+class AnalysisConfigExc : public ci::Exception {
+  public:
+    AnalysisConfigExc( const std::string &description ) : ci::Exception( description ) {}
+};
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+//! One published result of the analysis pipeline. Frames are immutable once published and are shared
+//! read-only by every consumer (windows, event outputs), so adding consumers adds no analysis cost.
+struct AnalysisFrame {
+    AnalysisFrame()
+        : mProcessedFrames( 0 ), mSampleRate( 0 ), mSpectralCentroid( 0 ), mInputLevel( 0 ), mPitchBin( 0 ), mPitchFreq( 0 ), mPitchLevel( 0 ),
+            mEstimateFreq( 0 ), mEstimateConfidence( 0 ), mEstimateStage( 0 )
+    {}
+
+    size_t  getNumBins() const                  { return mMagSpectrum.size(); }
+    float   getNyquist() const                  { return mSampleRate / 2.0f; }
+    float   getFreqForBin( float bin ) const    { return mMagSpectrum.empty() ? 0 : bin * getNyquist() / (float)mMagSpectrum.size(); }
+
+    uint64_t            mProcessedFrames;   //!< audio context frame count this frame was taken at
+    float               mSampleRate;
+    std::vector<float>  mMagSpectrum;       //!< linear magnitude, 0 - nyquist
+    float               mSpectralCentroid;  //!< hertz
+    float               mInputLevel;        //!< RMS of the analysis window, decibels (0 - 100)
+
+    // dominant pitch estimate
+    float               mPitchBin;          //!< fractional bin
+    float               mPitchFreq;         //!< hertz
+    float               mPitchLevel;        //!< magnitude at mPitchBin, decibels (0 - 100)
+
+    // estimate of the pitch cascade (see PitchEngine)
+    float               mEstimateFreq;          //!< hertz, 0 if unvoiced
+    float               mEstimateConfidence;    //!< 0 - 1
+    int                 mEstimateStage;         //!< PitchEngine::Stage that resolved it
+};
+
+typedef std::shared_ptr<const AnalysisFrame> AnalysisFrameRef;
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "AnalysisFrame.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+//! Something that AnalysisFrames are sent to outside of the process (or to the console).
+class AnalysisOutput {
+  public:
+    virtual ~AnalysisOutput() {}
+    //! Called once per published frame, on the analysis thread.
+    virtual void send( const AnalysisFrame &frame ) = 0;
+};
+
+typedef std::unique_ptr<AnalysisOutput> AnalysisOutputPtr;
+
+//! Prints a line to stdout whenever the pitch changes: the cascade's estimate (frequency, confidence and the stage
+//! that resolved it) and the centroid pitch, the latter only while it is above the config's pitchThreshold.
+class LogOutput : public AnalysisOutput {
+  public:
+    LogOutput( float minLevel = 10 );
+    void send( const AnalysisFrame &frame ) override;
+
+    //! Decibels the centroid pitch has to exceed, AnalysisConfig::mPitchThreshold.
+    void setMinLevel( float minLevel )  { mMinLevel = minLevel; }
+
+  private:
+    float   mMinLevel, mLastFreq, mLastEstimateFreq;
+};
+
+//! Sends "/pitch ,ffff frequency level centroid inputLevel" OSC messages over UDP.
+class OscOutput : public AnalysisOutput {
+  public:
+    OscOutput( const std::string &host, uint16_t port, const std::string &address = "/pitch" );
+    ~OscOutput();
+    void send( const AnalysisFrame &frame ) override;
+
+    bool isOpen() const     { return mSocket >= 0; }
+
+  private:
+    std::string             mAddress;
+    std::vector<uint8_t>    mPacket;
+    std::vector<uint8_t>    mDestination;   // sockaddr storage, kept opaque to avoid socket headers here
+    intptr_t                mSocket;
+};
+
+//! Layout of the shared memory block written by SharedMemoryOutput. Readers retry while mSequence is odd or
+//! changed during their read (a seqlock), so they never see a partially written frame.
+struct SharedPitchState {
+    volatile uint32_t   mSequence;
+    uint32_t            mReserved;
+    uint64_t            mProcessedFrames;
+    float               mSampleRate;
+    float               mPitchFreq, mPitchLevel;
+    float               mSpectralCentroid, mInputLevel;
+};
+
+//! Publishes the latest frame's values to a named shared memory block (SharedPitchState).
+class SharedMemoryOutput : public AnalysisOutput {
+  public:
+    explicit SharedMemoryOutput( const std::string &name );
+    ~SharedMemoryOutput();
+    void send( const AnalysisFrame &frame ) override;
+
+    bool isOpen() const     { return mState != nullptr; }
+
+  private:
+    std::string         mName;
+    SharedPitchState    *mState;
+    void                *mHandle;
+};
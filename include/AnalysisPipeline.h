@@ -0,0 +1,130 @@
+#pragma once
+
+#include "AnalysisConfig.h"
+#include "AnalysisFrame.h"
+#include "CallbackTimingNode.h"
+#include "RawSampleTap.h"
+#include "RateTables.h"
+#include "Resampler.h"
+#include "SpectralAnalyzer.h"
+#include "SpectralFeatures.h"
+#include "PitchEngine.h"
+
+#include "cinder/audio/InputNode.h"
+#include "cinder/audio/MonitorNode.h"
+#include "cinder/audio/OutputNode.h"
+#include "cinder/Signals.h"
+
+#include <atomic>
+#include <future>
+
+//! Owns the audio graph (input device -> monitor) and turns it into AnalysisFrames. One pipeline feeds any
+//! number of consumers: update() is called once per app tick and publishes at most one frame.
+class AnalysisPipeline {
+  public:
+    //! The largest window reconfigure() accepts. The monitor keeps this many frames at the analysis rate, which is
+    //! more device frames when the config's analysisRate is below the device's.
+    static const size_t kMaxWindowSize = AnalysisConfig::kMaxWindowSize;
+    //! Frames the raw sample tap holds: the pitch cascade's window for AnalysisConfig::kLowestPitch at 192 kHz (24000
+    //! frames, or as many source frames when resampling down to the analysis rate) plus the tap's write guard.
+    static const size_t kRawTapCapacity = 32768;
+
+    AnalysisPipeline();
+    ~AnalysisPipeline();
+
+    //! Builds the audio graph and starts processing.
+    void setup();
+
+    //! Publishes a new frame if the audio thread has processed new samples since the last call. Returns
+    //! true if it did. Must be called from a single thread.
+    bool update();
+
+    //! Switches the spectral analysis to \a format without touching the audio graph. The new analyzer is prepared
+    //! on a background thread and swapped in at the next published frame, and the frame's scalar features
+    //! are crossfaded from the old analyzer over one new window length. The window is clamped to kMaxWindowSize.
+    //! A request made while the previous one is still being prepared is started by update() once that is done.
+    void reconfigure( SpectralAnalyzer::Format format );
+    //! Applies \a config from the next frame on, reconfiguring the analyzer if its format changed. Cheap to call
+    //! every tick with the same snapshot. Must be called from the update() thread.
+    void setConfig( const AnalysisConfigRef &config );
+    const AnalysisConfigRef& getConfig() const  { return mConfig; }
+
+    //! Rate-dependent tables of the current analyzer, rebuilt when the device's sample rate, the FFT size or the config
+    //! change. Null before the first update().
+    const RateTablesRef& getRateTables() const  { return mRateTables; }
+
+    //! Format of the analyzer currently publishing frames.
+    const SpectralAnalyzer::Format& getAnalyzerFormat() const   { return mAnalyzer->getFormat(); }
+
+    //! The most recently published frame, never null after the first update().
+    const AnalysisFrameRef& getFrame() const    { return mFrame; }
+
+    //! The current input, replaced when devices come and go. Safe to call from any thread.
+    ci::audio::InputDeviceNodeRef               getInputDeviceNode() const      { return std::atomic_load( &mInputDeviceNode ); }
+    //! Incremented every time the input node is replaced.
+    uint32_t                                    getInputRevision() const        { return mInputRevision; }
+    //! True while devices are rebuilt on a worker, until update() has swapped the result in. Neither the context
+    //! nor the input node may be touched meanwhile. Must be called from the update() thread.
+    bool                                        isRebuilding() const            { return mInputRebuild.valid(); }
+    const ci::audio::MonitorNodeRef&            getMonitorNode() const          { return mMonitorNode; }
+    const CallbackTimingNodeRef&                getTimingNode() const           { return mTimingNode; }
+    //! Raw mono samples for time-domain consumers, each creates its own RawSampleTap::Reader.
+    const RawSampleTapRef&                      getRawSampleTap() const         { return mRawSampleTap; }
+
+    //! The pitch cascade, for its per-stage stats.
+    const PitchEngine&                          getPitchEngine() const          { return mPitchEngine; }
+
+  private:
+    void analyze( AnalysisFrame *frame );
+    void updateRateTables();
+    //! Flags the rate tables for a rebuild and the audio thread's policy for a new request. Called from any thread.
+    void deviceParamsDidChange();
+    //! Replaces the monitor with one holding \a windowSize device frames.
+    void resizeMonitor( size_t windowSize );
+    //! Picks the config's input device, its backup or the system default, whichever is present first.
+    static ci::audio::DeviceRef findInputDevice( const std::string &preferred, const std::string &backup );
+    //! Opens a replacement for the output if \a outputDevice is gone (it drives the context, nothing is processed
+    //! without it), then replaces the input if its device is gone or a preferred one appeared. Runs on a worker.
+    void rebuildDevices( const ci::audio::DeviceRef &outputDevice, const std::string &preferred, const std::string &backup );
+    //! A node on the default output if \a current is gone, otherwise null.
+    static ci::audio::OutputDeviceNodeRef createOutput( const ci::audio::DeviceRef &current );
+    //! Makes \a node the context's output. Called from update() once the rebuild worker is done.
+    void swapOutput( const ci::audio::OutputDeviceNodeRef &node );
+    void rebuildInput( const std::string &preferred, const std::string &backup );
+
+    ci::audio::InputDeviceNodeRef       mInputDeviceNode;   // only accessed atomically, rebuildInput() replaces it
+    std::atomic<uint32_t>               mInputRevision;
+    std::atomic<bool>                   mDevicesChanged;    // set from device notifications
+    std::future<void>                   mInputRebuild;
+    ci::audio::OutputDeviceNodeRef      mPendingOutput;     // written by the rebuild worker, read once its future is ready
+    ci::signals::ScopedConnection       mDevicesChangedConnection;
+    CallbackTimingNodeRef               mTimingNode;
+    RawSampleTapRef                     mRawSampleTap;
+    RawSampleTap::Reader                mRawReader;
+    PitchEngine                         mPitchEngine;
+    ci::audio::MonitorNodeRef           mMonitorNode;
+    Resampler                           mResampler;         // device rate -> config analysisRate
+    std::vector<float>                  mMonoBuffer;
+    ci::audio::Buffer                   mResampledBuffer;
+    std::vector<float>                  mResampledRaw;      // the cascade's raw window at the analysis rate
+    AnalysisConfigRef                   mConfig;
+
+    SpectralAnalyzerRef                 mAnalyzer;
+    SpectralAnalyzerRef                 mFadingAnalyzer;    // the previous analyzer, while crossfading
+    SpectralAnalyzerRef                 mPendingAnalyzer;   // handed over by the preparing thread, only accessed atomically
+    std::future<void>                   mPreparing;
+    SpectralAnalyzer::Format            mQueuedFormat;      // requested while mPreparing was still running
+    bool                                mFormatQueued;
+    uint64_t                            mFadeStartFrame;
+    ThreadPolicy                        mAudioThreadPolicy;     // last one handed to the timing node
+    std::atomic<bool>                   mAudioThreadRestarted;  // set with a new IO thread, mAudioThreadPolicy is reset
+
+    RateTablesRef                       mRateTables;
+    RateTablesRef                       mFadingRateTables;
+    std::atomic<bool>                   mRatesDirty;        // set from device notifications, which may come from any thread
+    ci::signals::ScopedConnection       mInputParamsConnection, mOutputParamsConnection;
+
+    AnalysisFrameRef                    mFrame;
+    std::shared_ptr<AnalysisFrame>      mSpareFrame;
+    uint64_t                            mLastProcessedFrames;
+};
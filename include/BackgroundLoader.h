@@ -0,0 +1,47 @@
+#pragma once
+
+#include "cinder/gl/Context.h"
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+//! Runs jobs on a worker thread that has its own GL context, shared with the context that was current when
+//! the loader was created. Textures, buffers and programs created by a job can be used by the main context
+//! as soon as the job's future is ready.
+class BackgroundLoader {
+  public:
+    BackgroundLoader();
+    ~BackgroundLoader();
+
+    template<typename T>
+    std::future<T> enqueue( std::function<T()> job )
+    {
+        auto task = std::make_shared<std::packaged_task<T()>>( std::move( job ) );
+        std::future<T> result = task->get_future();
+        push( [task] { ( *task )(); } );
+        return result;
+    }
+
+  private:
+    void push( std::function<void()> job );
+    void run();
+
+    ci::gl::ContextRef                  mContext;
+    std::thread                         mThread;
+    std::mutex                          mMutex;
+    std::condition_variable             mCondition;
+    std::deque<std::function<void()>>   mJobs;
+    bool                                mQuit;
+};
+
+//! Returns true if \a future holds a result (or exception) that get() will return without blocking.
+template<typename T>
+bool isReady( const std::future<T> &future )
+{
+    return future.valid() && future.wait_for( std::chrono::seconds( 0 ) ) == std::future_status::ready;
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "AnalysisConfig.h"
+#include "NoteTables.h"
+#include "PitchEngine.h"
+#include "RateTables.h"
+#include "SpectralAnalyzer.h"
+#include "SpectralFeatures.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+//! The analysis of AnalysisPipeline - spectrum, centroid pitch mapping and the pitch cascade - fed with blocks of mono
+//! samples by a host instead of an audio graph, for embedding it in other engines and plugins (see InputAnalyzerC.h).
+//! Everything is allocated by the constructor and setConfig(); process() only copies the block into its history, so
+//! it can run on the host's audio thread. Not thread-safe, the host serializes calls. The config's analysisRate is
+//! ignored, the host's rate is analyzed directly.
+class BlockAnalyzer {
+  public:
+    //! Analyzes every \a hopSize frames at \a sampleRate. A null \a config uses the defaults.
+    BlockAnalyzer( float sampleRate, size_t hopSize = 512, const AnalysisConfigRef &config = AnalysisConfigRef() );
+
+    //! Reallocates for \a config's analysis format. Not for the audio thread.
+    void setConfig( const AnalysisConfigRef &config );
+    const AnalysisConfigRef&    getConfig() const   { return mConfig; }
+
+    //! Appends \a numFrames samples. Returns true if a hop completed and the results were updated; a block spanning
+    //! several hops is analyzed once, at its end.
+    bool process( const float *samples, size_t numFrames );
+
+    //! Frames from an input sample to the first result whose spectral window is centered past it, at most.
+    size_t  getLatency() const      { return mHopSize + mAnalyzer->getWindowSize() / 2; }
+    size_t  getHopSize() const      { return mHopSize; }
+    float   getSampleRate() const   { return mSampleRate; }
+
+    //! Input frames processed when the current results were analyzed.
+    uint64_t                    getAnalyzedFrames() const   { return mAnalyzedFrames; }
+    const SpectralFeatures&     getFeatures() const         { return mFeatures; }
+    const PitchEngine::Result&  getEstimate() const         { return mEstimate; }
+    //! The estimate against the config's tuner reference.
+    const NoteReading&          getNote() const             { return mNote; }
+    //! The analyzer's own magnitude spectrum, valid until the next process().
+    const std::vector<float>&   getMagSpectrum() const      { return mAnalyzer->getMagSpectrum(); }
+    const PitchEngine&          getPitchEngine() const      { return mPitchEngine; }
+
+  private:
+    void analyze();
+
+    float                   mSampleRate;
+    size_t                  mHopSize;
+    AnalysisConfigRef       mConfig;
+    SpectralAnalyzerRef     mAnalyzer;
+    RateTablesRef           mRateTables;
+    PitchEngine             mPitchEngine;
+    size_t                  mRawWindow;         // frames the pitch cascade reads, 2.5 of the longest period
+
+    // mirrored like RawSampleTap's ring: every sample is written at i and i + mCapacity, so the latest frames are
+    // always contiguous and the analyzers read them in place
+    std::vector<float>      mHistory;
+    size_t                  mCapacity, mWritePosition;
+    size_t                  mPendingFrames;     // since the last analysis
+    uint64_t                mNumFrames, mAnalyzedFrames;
+
+    SpectralFeatures        mFeatures;
+    PitchEngine::Result     mEstimate;
+    NoteReading             mNote;
+};
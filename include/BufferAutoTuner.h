@@ -0,0 +1,70 @@
+#pragma once
+
+#include "CallbackTimingNode.h"
+
+#include "cinder/audio/InputNode.h"
+#include "cinder/Filesystem.h"
+
+#include <string>
+#include <vector>
+
+//! Finds the smallest frames-per-block the input device sustains: probes halving block sizes, measures callback
+//! jitter and xruns at each, and keeps the last stable one. The result is stored per device name and applied
+//! directly on later runs. Driven by update() from the thread that owns the audio graph, so device formats are
+//! never changed underneath the analysis. It must not run while AnalysisPipeline rebuilds its devices, see suspend().
+class BufferAutoTuner {
+  public:
+    struct Options {
+        Options()
+            : mSettleSeconds( 0.5 ), mMeasureSeconds( 1.5 ), mMaxJitter( 0.5 ), mMinCallbackRatio( 0.9 ), mMinFramesPerBlock( 32 )
+        {}
+
+        double  mSettleSeconds;     //!< ignored after each format change
+        double  mMeasureSeconds;    //!< measured per block size
+        double  mMaxJitter;         //!< largest allowed callback deviation, as a fraction of the block period
+        double  mMinCallbackRatio;  //!< fraction of the expected callbacks that have to arrive
+        size_t  mMinFramesPerBlock;
+    };
+
+    BufferAutoTuner( const Options &options = Options() );
+
+    //! Applies the size stored for \a input's device, or starts probing if there is none or \a force is set.
+    void start( const ci::audio::InputDeviceNodeRef &input, const CallbackTimingNodeRef &timing, bool force = false );
+    //! Moves over to \a input after the pipeline replaced its input node. A running probe starts over on the new
+    //! device, its results so far belong to the old one. Otherwise the size stored for the new device is applied,
+    //! without probing if there is none.
+    void setInput( const ci::audio::InputDeviceNodeRef &input );
+    //! Advances the probe, \a time is in seconds.
+    void update( double time );
+    //! Call instead of update() while the pipeline rebuilds its devices, neither the input nor the context may be
+    //! touched then. The measurement in progress is discarded and starts over with a settle phase.
+    void suspend();
+
+    bool    isProbing() const           { return mProbing; }
+    //! The settled size, 0 while probing or before start().
+    size_t  getFramesPerBlock() const   { return mProbing ? 0 : mResult; }
+
+    //! ~/.InputAnalyzer-buffers.json
+    static ci::fs::path getStorePath();
+
+  private:
+    enum class Phase { SETTLING, MEASURING };
+
+    void apply( size_t framesPerBlock );
+    bool measure() const;
+    void finish();
+
+    static size_t   loadStored( const std::string &deviceName );
+    static void     store( const std::string &deviceName, size_t framesPerBlock );
+
+    Options                         mOptions;
+    ci::audio::InputDeviceNodeRef   mInput;
+    CallbackTimingNodeRef           mTiming;
+    std::vector<size_t>             mCandidates;
+    size_t                          mCandidateIndex;
+    size_t                          mResult;
+    bool                            mProbing, mForce;
+    Phase                           mPhase;
+    double                          mPhaseStart;
+    uint64_t                        mLastOverrun, mLastUnderrun;
+};
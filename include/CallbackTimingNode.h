@@ -0,0 +1,55 @@
+#pragma once
+
+#include "ThreadPolicy.h"
+
+#include "cinder/audio/Node.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+
+//! Pass-through node that measures how regularly the audio thread calls it. The audio thread only writes
+//! atomics, so the stats can be read (and reset) from any thread while audio runs. Being the analysis chain's
+//! foothold on the audio thread, it also applies the audio thread's ThreadPolicy.
+class CallbackTimingNode : public ci::audio::Node {
+  public:
+    CallbackTimingNode( const Format &format = Format() );
+
+    struct Stats {
+        uint64_t    mNumCallbacks;
+        double      mMaxDeviation;  //!< seconds, largest difference between a callback interval and the block period
+        double      mMeanInterval;  //!< seconds
+    };
+
+    //! Stats since the last reset().
+    Stats   getStats() const;
+    //! Starts a new measurement with the next callback.
+    void    reset()             { mResetRequested = true; }
+
+    //! Applies \a policy on the audio thread at its next callback. Returns false, ignoring \a policy, while an earlier
+    //! request hasn't been applied yet.
+    bool    requestThreadPolicy( const ThreadPolicy &policy );
+    //! Fills \a result and returns true once per applied request.
+    bool    takeThreadPolicyResult( ThreadPolicyResult *result );
+
+  protected:
+    void process( ci::audio::Buffer *buffer ) override;
+
+  private:
+    std::chrono::steady_clock::time_point   mLastCallback;      // audio thread only
+    bool                                    mHasLastCallback;   // audio thread only
+    std::atomic<bool>                       mResetRequested;
+    std::atomic<uint64_t>                   mNumIntervals;
+    std::atomic<uint64_t>                   mTotalNanoseconds;
+    std::atomic<uint64_t>                   mMaxDeviationNanoseconds;
+
+    // handshake: the requesting thread only writes the policy while mPolicyApplied == mPolicyRequest, the audio
+    // thread only writes the result before publishing mPolicyApplied
+    ThreadPolicy                            mRequestedPolicy;
+    ThreadPolicyResult                      mPolicyResult;
+    std::atomic<uint32_t>                   mPolicyRequest, mPolicyApplied;
+    uint32_t                                mPolicyReported;
+};
+
+typedef std::shared_ptr<CallbackTimingNode> CallbackTimingNodeRef;
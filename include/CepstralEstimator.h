@@ -0,0 +1,34 @@
+#pragma once
+
+#include "PitchEstimate.h"
+
+#include "cinder/audio/Buffer.h"
+#include "cinder/audio/dsp/Fft.h"
+
+#include <cstddef>
+
+//! Real cepstrum: the inverse FFT of the log magnitude spectrum peaks at the period of a harmonic series whether or
+//! not its fundamental is present, which suits voice and low instruments. Reuses the FFT plan that produced the
+//! spectrum, on buffers that are only reallocated when the FFT size changes. Confidence comes from the peak's height
+//! over the cepstrum's RMS in the searched range, scaled by how high noise alone peaks over that many quefrencies.
+//!
+//! Only periods that fit three times in the window are searched, so the stage covers pitches above about
+//! sampleRate / ( windowSize / 3 ): roughly 130 Hz with a 1024 frame window at 44.1 kHz, 32 Hz with 4096. Harmonics
+//! only stand apart from about six periods per window though, bass below that is left to YIN.
+class CepstralEstimator {
+  public:
+    CepstralEstimator();
+
+    //! \a magSpectrum holds the \a numBins linear magnitudes \a fft produced at \a sampleRate (fft's size is
+    //! 2 * numBins) from \a windowSize frames. Searches pitches between \a minFreq and \a maxFreq hertz whose period
+    //! fits at least three times in the window, below that the harmonics blur together.
+    PitchEstimate estimate( const float *magSpectrum, size_t numBins, size_t windowSize, float sampleRate, float minFreq, float maxFreq,
+                            ci::audio::dsp::Fft *fft );
+
+    //! Allocates the buffers for \a fftSize, which estimate() otherwise does on first use.
+    void reserve( size_t fftSize );
+
+  private:
+    ci::audio::BufferSpectral   mLogSpectrum;
+    ci::audio::Buffer           mCepstrum;
+};
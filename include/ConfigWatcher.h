@@ -0,0 +1,39 @@
+#pragma once
+
+#include "AnalysisConfig.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+//! Keeps an AnalysisConfig in sync with a JSON file. A background thread polls the file, parses and validates
+//! any change and publishes it as a new immutable snapshot. Invalid edits are reported and the last good
+//! config stays active, so a typo during soundcheck never interrupts the audio.
+class ConfigWatcher {
+  public:
+    ConfigWatcher();
+    ~ConfigWatcher();
+
+    //! Loads \a path, writing the defaults there first if it doesn't exist, and starts watching it.
+    void start( const ci::fs::path &path, double pollSeconds = 0.5 );
+    void stop();
+
+    //! The latest valid config, never null. Safe to call from any thread.
+    AnalysisConfigRef getConfig() const     { return std::atomic_load( &mConfig ); }
+
+    const ci::fs::path& getPath() const     { return mPath; }
+
+  private:
+    void run( double pollSeconds );
+    //! Re-parses the file if its contents changed, returns true if a new config was published.
+    bool load();
+
+    ci::fs::path                mPath;
+    AnalysisConfigRef           mConfig;        // only accessed atomically
+    std::string                 mContents;      // of the last load, accessed by the watcher thread after start()
+    std::thread                 mThread;
+    std::mutex                  mMutex;
+    std::condition_variable     mCondition;
+    bool                        mRunning;
+};
@@ -0,0 +1,119 @@
+#pragma once
+
+#include "cinder/Exception.h"
+#include "cinder/Filesystem.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//! Query by humming over the melodies (PitchContour intervals) of a corpus of clips. The index is one file that is
+//! memory-mapped rather than read, so opening it costs nothing and queries only page in the postings they touch.
+//!
+//! Candidates come from an inverted index of interval n-grams, rounded to semitones. Sung intervals are rarely in tune,
+//! so the query looks up every semitone near each of its intervals. Each hit places the query somewhere in a clip, and
+//! clips are ranked by how many query positions agree on one placement. The best candidates are then re-ranked by DTW
+//! distance between the query's notes and the clip's at that alignment, both relative to their mean pitch, skipping
+//! any whose LB_Keogh lower bound can't beat the results already kept. Open indexes are read-only, queries can run
+//! concurrently.
+class ContourIndex {
+  public:
+    //! Intervals per n-gram.
+    static const size_t kGramLength = 3;
+    //! Semitones; larger intervals share the n-gram symbol of an octave.
+    static const int    kMaxInterval = 12;
+
+    struct Match {
+        uint32_t    mClip;
+        std::string mName;
+        float       mDistance;      //!< RMS semitones between the query's notes and the aligned notes
+        size_t      mPosition;      //!< interval of the clip the query starts at
+        uint32_t    mVotes;         //!< query positions whose n-grams agree on the alignment
+    };
+
+    struct QueryOptions {
+        QueryOptions() : mMaxResults( 10 ), mMaxCandidates( 500 ), mIntervalTolerance( 0.9f ), mBand( 2 ) {}
+
+        size_t  mMaxResults;
+        size_t  mMaxCandidates;     //!< clips whose n-gram hits agree the most that are re-ranked by DTW
+        float   mIntervalTolerance; //!< semitones; a sung interval looks up the n-grams of every semitone this close
+        size_t  mBand;              //!< Sakoe-Chiba radius of the DTW and LB_Keogh envelope, notes
+    };
+
+    //! Maps the index at \a path. Throws ContourIndexExc if it can't be opened or isn't a valid index.
+    explicit ContourIndex( const ci::fs::path &path );
+    ~ContourIndex();
+
+    //! The best matches for a query's \a intervals, closest first. Empty if it has less than kGramLength intervals.
+    std::vector<Match>  query( const std::vector<float> &intervals, const QueryOptions &options = QueryOptions() ) const;
+
+    size_t      getNumClips() const     { return (size_t)mHeader->mNumClips; }
+    std::string getClipName( size_t clip ) const;
+
+    //! File format, native byte order. Sections follow the header in this order, each aligned to 8 bytes.
+    struct Header {
+        char        mMagic[4];          // "IACI"
+        uint32_t    mVersion;
+        uint32_t    mGramLength;
+        uint32_t    mMaxInterval;
+        uint64_t    mNumClips;
+        uint64_t    mNumPostings;
+        uint64_t    mNumIntervals;
+        uint64_t    mNamesSize;
+    };
+    //! One occurrence of an n-gram. Postings are sorted by n-gram, then clip, then position; the n-gram table holds
+    //! the first posting of every n-gram, plus the total.
+    struct Posting {
+        uint32_t    mClip;
+        uint32_t    mPosition;
+    };
+    struct Clip {
+        uint32_t    mIntervalOffset;
+        uint32_t    mNumIntervals;
+        uint32_t    mNameOffset;
+        uint32_t    mNameLength;
+    };
+
+    static const uint32_t   kVersion = 1;
+    static const size_t     kNumSymbols = 2 * kMaxInterval + 1;
+    static const size_t     kNumGrams = kNumSymbols * kNumSymbols * kNumSymbols;
+
+    //! The n-gram symbol of an interval.
+    static size_t getSymbol( float interval );
+
+  private:
+    ContourIndex( const ContourIndex & ) = delete;
+    ContourIndex& operator=( const ContourIndex & ) = delete;
+
+    const uint8_t   *mData;
+    size_t          mSize;
+    void            *mHandle;           // file mapping, Windows only
+
+    const Header    *mHeader;
+    const uint32_t  *mGramStarts;       // kNumGrams + 1
+    const Posting   *mPostings;
+    const Clip      *mClips;
+    const float     *mIntervals;
+    const char      *mNames;
+};
+
+//! Collects the contours of a corpus and writes them as a ContourIndex.
+class ContourIndexWriter {
+  public:
+    void    add( const std::string &name, const std::vector<float> &intervals );
+    size_t  getNumClips() const     { return mClips.size(); }
+
+    //! Throws ContourIndexExc if \a path can't be written.
+    void    write( const ci::fs::path &path ) const;
+
+  private:
+    std::vector<ContourIndex::Clip> mClips;
+    std::vector<float>              mIntervals;
+    std::string                     mNames;
+};
+
+class ContourIndexExc : public ci::Exception {
+  public:
+    ContourIndexExc( const std::string &description ) : ci::Exception( description ) {}
+};
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "cinder/gl/Pbo.h"
+#include "cinder/Filesystem.h"
+
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//! Records the rendered frames of a window without stalling the render thread. Frames are read back
+//! asynchronously into a ring of pixel buffer objects; once the GPU is done with one it is mapped and the
+//! mapping itself is handed to a background thread that encodes it (raw RGBA or YUV4MPEG2) to a file or pipe.
+//! The render thread never touches the pixels, it unmaps buffers on a later frame once the encoder is done.
+class FrameCapture {
+  public:
+    enum class Encoding { RAW_RGBA, Y4M };
+
+    FrameCapture();
+    ~FrameCapture();
+
+    //! Starts recording frames of \a pixelSize. If \a destination starts with '|' the rest is run as a
+    //! command and frames are piped to its stdin (e.g. "| ffmpeg -i - show.mp4"), otherwise it is a file path.
+    //! Pipes are not available on iOS, which doesn't allow spawning processes.
+    bool start( const std::string &destination, const ci::ivec2 &pixelSize, float frameRate, Encoding encoding = Encoding::Y4M );
+    //! Flushes the frames still in flight and stops the encoder thread.
+    void stop();
+
+    bool isRecording() const    { return mRecording; }
+
+    //! Queues a readback of the current read framebuffer. Call at the end of draw(), before the buffers are swapped.
+    void captureFrame();
+
+    size_t getNumCapturedFrames() const     { return mNumCapturedFrames; }
+    //! Frames dropped because all buffers were still queued for the encoder or on the GPU, or a readback timed out.
+    size_t getNumDroppedFrames() const      { return mNumDroppedFrames; }
+    //! Seconds captureFrame() took on the render thread, the longest and the mean since start().
+    double getMaxCaptureTime() const        { return mMaxCaptureTime; }
+    double getMeanCaptureTime() const       { return mNumCaptureCalls ? mTotalCaptureTime / (double)mNumCaptureCalls : 0; }
+
+  private:
+    struct Readback {
+        ci::gl::PboRef  mPbo;
+        GLsync          mFence;
+        const uint8_t   *mPixels;   // mapped while the encoder owns it
+    };
+
+    //! Maps the oldest pending readback and queues it for the encoder. Returns false if \a wait is false and it
+    //! isn't ready yet. If waiting times out or fails the buffer is queued unmapped and counted as dropped.
+    bool retireReadback( bool wait );
+    //! Unmaps the buffers the encoder is done with, so they can be read into again.
+    void releaseEncoded();
+    void encodeLoop();
+    void writeFrame( const uint8_t *pixels );
+
+    ci::ivec2                   mSize;
+    Encoding                    mEncoding;
+    bool                        mRecording;
+    std::FILE                   *mOutput;
+    bool                        mOutputIsPipe;
+
+    // render thread only. The ring holds, in order: buffers queued for (or being written by) the encoder, buffers
+    // the GPU is still reading into, free buffers.
+    std::vector<Readback>       mReadbacks;
+    size_t                      mNextReadback, mNumPending, mNumQueued;
+    size_t                      mNumCapturedFrames, mNumDroppedFrames;
+    size_t                      mNumCaptureCalls;
+    double                      mMaxCaptureTime, mTotalCaptureTime;
+
+    // shared with the encoder thread
+    std::thread                 mEncoderThread;
+    std::mutex                  mMutex;
+    std::condition_variable     mCondition;
+    std::deque<size_t>          mFilledReadbacks;   // mapped, in ring order
+    size_t                      mNumEncoded;        // written since the render thread last released
+    bool                        mStopEncoder;
+
+    // encoder thread only
+    std::vector<uint8_t>        mPlanes;
+};
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+//! Maps spectrum bins onto the pixel columns of a plot, in either direction. All tables are rebuilt only
+//! when the layout, FFT size or scale change, so per-frame drawing and hit testing are O(1) lookups.
+class FrequencyAxis {
+  public:
+    //! LINEAR spans 0 - nyquist, LOG spans getMinFreq() - nyquist and NOTES spans a fixed range of
+    //! MIDI notes (see setNoteRange()) with equal width per semitone.
+    enum class Scale { LINEAR, LOG, NOTES };
+
+    //! A vertical reference line, major lines are decades / octaves and carry a label in the overlay.
+    struct GridLine {
+        float   mColumn;
+        float   mFreq;
+        int     mMidiNote;  // -1 unless the scale is Scale::NOTES
+        bool    mMajor;
+    };
+
+    FrequencyAxis();
+
+    //! Rebuilds the mapping tables. Returns false (and does nothing) when nothing has changed.
+    bool setup( size_t numBins, size_t numColumns, float nyquist, Scale scale );
+
+    size_t  getNumBins() const      { return mNumBins; }
+    size_t  getNumColumns() const   { return mColumnBegin.size(); }
+    float   getNyquist() const      { return mNyquist; }
+    Scale   getScale() const        { return mScale; }
+
+    //! Lowest frequency shown when the scale is Scale::LOG. Takes effect on the next setup().
+    void    setMinFreq( float freq )    { mMinFreq = freq; mNumBins = 0; }
+    float   getMinFreq() const          { return mMinFreq; }
+    //! MIDI note range shown when the scale is Scale::NOTES. Takes effect on the next setup().
+    void    setNoteRange( int lowNote, int highNote )   { mLowNote = lowNote; mHighNote = highNote; mNumBins = 0; }
+
+    //! First bin of each column. Columns narrower than a bin repeat the bin that covers them.
+    const uint32_t* getColumnBegin() const  { return mColumnBegin.data(); }
+    //! One past the last bin of each column, always greater than the column's begin.
+    const uint32_t* getColumnEnd() const    { return mColumnEnd.data(); }
+
+    //! Returns the bin under \a column, for hit testing. Columns outside the plot are clamped.
+    size_t getBinForColumn( float column ) const;
+    //! Returns the (fractional) column that the center of \a bin is drawn at.
+    float getColumnForBin( float bin ) const;
+    //! Returns the (fractional) column that \a freq is drawn at.
+    float getColumnForFreq( float freq ) const;
+    //! Returns the frequency at the left edge of \a column, which may be fractional.
+    float getFreqForColumn( float column ) const;
+
+    const std::vector<GridLine>& getGridLines() const   { return mGridLines; }
+    //! Incremented every time the tables are rebuilt, so cached renderings of the axis know when to refresh.
+    uint32_t getRevision() const                        { return mRevision; }
+
+  private:
+    float getFreqForNormalized( float t ) const;
+    float getNormalizedForFreq( float freq ) const;
+    void  buildGridLines();
+
+    size_t                  mNumBins;
+    float                   mNyquist, mMinFreq, mLowFreq, mHighFreq;
+    int                     mLowNote, mHighNote;
+    Scale                   mScale;
+    uint32_t                mRevision;
+    std::vector<uint32_t>   mColumnBegin, mColumnEnd, mColumnBin;
+    std::vector<float>      mBinColumn;
+    std::vector<GridLine>   mGridLines;
+};
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "cinder/gl/TextureFont.h"
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+//! Caches the glyph placements and measured size of recently drawn strings, so dynamic text that repeats
+//! (readouts, note names) is laid out once and then drawn straight from the font's glyph atlas.
+class GlyphRunCache {
+  public:
+    explicit GlyphRunCache( size_t capacity = 64 );
+
+    //! Sets the font runs are laid out with. Clears the cache if the font changed.
+    void setFont( const ci::gl::TextureFontRef &font );
+    const ci::gl::TextureFontRef& getFont() const   { return mFont; }
+
+    void        drawString( const std::string &str, const ci::vec2 &baseline );
+    ci::vec2    measureString( const std::string &str );
+
+    size_t getNumHits() const       { return mNumHits; }
+    size_t getNumMisses() const     { return mNumMisses; }
+
+  private:
+    struct Run {
+        std::vector<std::pair<ci::Font::Glyph, ci::vec2>>   mPlacements;
+        ci::vec2                                            mSize;
+        uint64_t                                            mLastUsed;
+    };
+
+    const Run& getRun( const std::string &str );
+
+    ci::gl::TextureFontRef                  mFont;
+    std::unordered_map<std::string, Run>    mRuns;
+    size_t                                  mCapacity, mNumHits, mNumMisses;
+    uint64_t                                mClock;
+};
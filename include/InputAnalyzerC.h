@@ -0,0 +1,87 @@
+/*
+Stable C interface to the InputAnalyzer pitch analysis (see BlockAnalyzer), for embedding it in other engines and
+audio plugins. The host feeds mono blocks from its own audio callback; results are written into structs the host owns.
+
+Nothing is allocated or copied out after ia_create(), ia_set_preset() and ia_configure(), so ia_process() and the
+getters are safe to call on a realtime thread. Calls on one analyzer must not overlap, the host serializes them.
+*/
+
+#ifndef INPUT_ANALYZER_C_H
+#define INPUT_ANALYZER_C_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined( _WIN32 )
+    #if defined( IA_BUILDING_LIBRARY )
+        #define IA_API __declspec( dllexport )
+    #else
+        #define IA_API __declspec( dllimport )
+    #endif
+#else
+    #define IA_API __attribute__(( visibility( "default" ) ))
+#endif
+
+/* Bumped whenever a function or struct changes incompatibly. */
+#define IA_API_VERSION 1
+
+/* Status codes */
+#define IA_OK                   0   /* a new result was written */
+#define IA_PENDING              1   /* less than a hop since the last result, nothing written */
+#define IA_ERROR_ARGUMENT       -1
+#define IA_ERROR_CONFIG         -2  /* see ia_get_last_error() */
+#define IA_ERROR_INTERNAL       -3
+
+/* ia_result.estimate_stage, the pitch cascade stage that resolved the estimate */
+#define IA_STAGE_SILENT         0
+#define IA_STAGE_ZERO_CROSSING  1
+#define IA_STAGE_SPECTRAL       2
+#define IA_STAGE_CEPSTRAL       3
+#define IA_STAGE_YIN            4
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct ia_analyzer ia_analyzer;
+
+typedef struct ia_result {
+    uint32_t    struct_size;            /* set by the host to sizeof( ia_result ); only the fields that fit are written */
+    uint64_t    analyzed_frames;        /* input frames processed when this was analyzed */
+    float       input_level;            /* RMS of the spectral window, decibels (0 - 100) */
+    float       spectral_centroid;      /* hertz */
+    float       pitch_freq;             /* dominant pitch from the centroid mapping, hertz */
+    float       pitch_level;            /* decibels (0 - 100) */
+    float       estimate_freq;          /* pitch cascade estimate, hertz, 0 if unvoiced */
+    float       estimate_confidence;    /* 0 - 1 */
+    int32_t     estimate_stage;         /* IA_STAGE_* */
+    int32_t     note;                   /* nearest MIDI note of the estimate, -1 if unvoiced */
+    float       cents;                  /* deviation from it against the tuner reference, -50 - 50 */
+} ia_result;
+
+IA_API uint32_t     ia_get_api_version( void );
+
+/* Analyzes mono input at sample_rate every hop_size frames, with the default config. NULL on failure. */
+IA_API ia_analyzer* ia_create( float sample_rate, uint32_t hop_size );
+IA_API void         ia_destroy( ia_analyzer *analyzer );
+
+/* Switches to one of the config's analysis presets ("fast", "default", "bass"). Allocates, not for the audio thread. */
+IA_API int32_t      ia_set_preset( ia_analyzer *analyzer, const char *name );
+/* Replaces the whole config with a JSON document in the format of InputAnalyzer.json. Allocates, not for the audio thread. */
+IA_API int32_t      ia_configure( ia_analyzer *analyzer, const char *json );
+/* Description of the last failed ia_set_preset() / ia_configure(), owned by the analyzer. */
+IA_API const char*  ia_get_last_error( const ia_analyzer *analyzer );
+
+/* Appends num_frames mono samples. Returns IA_OK and fills result (which may be NULL) when a hop completed, IA_PENDING otherwise. */
+IA_API int32_t      ia_process( ia_analyzer *analyzer, const float *block, size_t num_frames, ia_result *result );
+
+/* Frames from an input sample to the first result whose spectral window is centered past it, at most. */
+IA_API uint32_t     ia_get_latency( const ia_analyzer *analyzer );
+/* The linear magnitude spectrum of the latest result, 0 - nyquist, without copying. Valid until the next ia_process(). */
+IA_API const float* ia_get_spectrum( const ia_analyzer *analyzer, size_t *num_bins );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INPUT_ANALYZER_C_H */
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+//! Equal-tempered note naming for the tuner. The tables are constexpr and hertz -> note goes through a polynomial
+//! log2, so a reading costs a handful of multiplies per frame.
+
+//! Pitch class names from C, sharps only.
+constexpr const char *kNoteNames[12] = { "C", "C#", "D", "D#", "E", "F", "F#", "G", "G#", "A", "A#", "B" };
+//! 2^(i / 12), the frequency ratio of i semitones.
+constexpr float kSemitoneRatios[12] = { 1.0f, 1.059463094f, 1.122462048f, 1.189207115f, 1.259921050f, 1.334839854f,
+                                        1.414213562f, 1.498307077f, 1.587401052f, 1.681792831f, 1.781797436f, 1.887748625f };
+//! MIDI note of A4, the tuning reference.
+constexpr int kReferenceNote = 69;
+
+constexpr int   getNotePitchClass( int note )   { return ( note % 12 + 12 ) % 12; }
+//! Scientific pitch notation octave, middle C (60) is C4.
+constexpr int   getNoteOctave( int note )       { return ( note - getNotePitchClass( note ) ) / 12 - 1; }
+constexpr float getOctaveScale( int octaves )   { return octaves == 0 ? 1.0f : octaves > 0 ? 2 * getOctaveScale( octaves - 1 ) : 0.5f * getOctaveScale( octaves + 1 ); }
+
+//! Equal-tempered frequency of MIDI \a note, with A4 at \a reference hertz.
+constexpr float getNoteFreq( int note, float reference = 440 )
+{
+    return reference * kSemitoneRatios[getNotePitchClass( note - kReferenceNote )]
+            * getOctaveScale( ( note - kReferenceNote - getNotePitchClass( note - kReferenceNote ) ) / 12 );
+}
+
+static_assert( getNoteFreq( 57 ) == 220.0f && getNoteFreq( 81 ) == 880.0f, "note tables are off" );
+
+//! log2 of \a x (> 0, normal) from its exponent bits and a degree 5 polynomial over the mantissa, within 3e-5
+//! (0.03 cents) of the exact value.
+inline float fastLog2( float x )
+{
+    uint32_t bits;
+    memcpy( &bits, &x, sizeof( bits ) );
+    int exponent = (int)( ( bits >> 23 ) & 0xff ) - 127;
+    bits = ( bits & 0x007fffff ) | 0x3f800000;
+    float mantissa;
+    memcpy( &mantissa, &bits, sizeof( mantissa ) );
+
+    float t = mantissa - 1;
+    return (float)exponent + t * ( 1.441825f + t * ( -0.7086789f + t * ( 0.4154112f + t * ( -0.1944083f + t * 0.04587895f ) ) ) );
+}
+
+//! Fractional MIDI note of \a freq hertz, with A4 at \a reference hertz.
+inline float freqToNote( float freq, float reference = 440 )
+{
+    return (float)kReferenceNote + 12 * fastLog2( freq / reference );
+}
+
+//! Frequency of the fractional MIDI \a note, with A4 at \a reference hertz; the inverse of freqToNote(). Not for the
+//! per-frame path, integer notes are cheaper through getNoteFreq().
+inline float noteToFreq( float note, float reference = 440 )
+{
+    return reference * exp2( ( note - (float)kReferenceNote ) / 12 );
+}
+
+//! A pitch as its nearest equal-tempered note and the deviation from it.
+struct NoteReading {
+    NoteReading() : mNote( -1 ), mCents( 0 ) {}
+
+    //! Reads \a freq hertz against A4 = \a reference hertz. Invalid outside MIDI notes 0 - 127.
+    NoteReading( float freq, float reference = 440 )
+        : NoteReading()
+    {
+        if( freq <= 0 || reference <= 0 )
+            return;
+
+        float note = freqToNote( freq, reference );
+        int nearest = (int)floor( note + 0.5f );
+        if( nearest < 0 || nearest > 127 )
+            return;
+
+        mNote = nearest;
+        mCents = ( note - (float)nearest ) * 100;
+    }
+
+    bool        isValid() const     { return mNote >= 0; }
+    const char* getName() const     { return kNoteNames[getNotePitchClass( mNote )]; }
+    int         getOctave() const   { return getNoteOctave( mNote ); }
+
+    int     mNote;      //!< MIDI, -1 if invalid
+    float   mCents;     //!< -50 - 50, sharp is positive
+};
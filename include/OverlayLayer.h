@@ -0,0 +1,33 @@
+#pragma once
+
+#include "FrequencyAxis.h"
+
+#include "cinder/gl/Fbo.h"
+#include "cinder/gl/TextureFont.h"
+#include "cinder/Rect.h"
+
+//! The static parts of the display - axis labels, grid lines and their frequency / note names - rendered
+//! once into an Fbo and composited with a single textured quad. The layer is only re-rendered when the
+//! window size, content scale, plot bounds or frequency axis change.
+class OverlayLayer {
+  public:
+    OverlayLayer();
+
+    void draw( const ci::ivec2 &windowSize, float contentScale, const ci::Rectf &plotBounds, const FrequencyAxis &axis );
+
+    //! The font labels are drawn with, rasterized at the content scale passed to draw(). Nothing is drawn without one.
+    void setFont( const ci::gl::TextureFontRef &font );
+    //! Forces the layer to be re-rendered on the next draw().
+    void markDirty()    { mDirty = true; }
+
+  private:
+    void render( const ci::Rectf &plotBounds, const FrequencyAxis &axis );
+
+    ci::gl::FboRef          mFbo;
+    ci::gl::TextureFontRef  mFont;
+    ci::ivec2               mWindowSize;
+    float                   mContentScale;
+    ci::Rectf               mPlotBounds;
+    uint32_t                mAxisRevision;
+    bool                    mDirty;
+};
@@ -0,0 +1,10 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+
+//! Calls \a work for every index below \a numItems, handing them out one at a time to \a numThreads threads (0 for
+//! every core), the calling thread among them. Carries on with the threads that started if the system refuses more.
+//! Stops handing out indices once \a work returns false or throws; the first exception is rethrown after every thread
+//! has finished.
+void parallelFor( size_t numItems, size_t numThreads, const std::function<bool( size_t )> &work );
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "PitchEstimate.h"
+
+#include <cstddef>
+#include <vector>
+
+//! Turns a pitch track into a melody that doesn't depend on key or tempo, for query by humming (see ContourIndex).
+//! Voiced hops are grouped into notes while the pitch holds within a tolerance, and the contour is the sequence of
+//! intervals between consecutive notes, in semitones. Fed one hop at a time, so live input is segmented as it arrives.
+class PitchContour {
+  public:
+    struct Options {
+        Options() : mMinConfidence( 0.5f ), mNoteTolerance( 0.6f ), mMinNoteHops( 3 ), mMaxGapHops( 2 ) {}
+
+        float   mMinConfidence;     //!< estimates below are treated as unvoiced
+        float   mNoteTolerance;     //!< semitones from the note's mean pitch before a new note starts
+        size_t  mMinNoteHops;       //!< shorter notes are dropped, they are transitions or octave glitches
+        size_t  mMaxGapHops;        //!< unvoiced hops a note survives (consonants, vibrato dropouts)
+    };
+
+    explicit PitchContour( const Options &options = Options() );
+
+    void    addHop( const PitchEstimate &estimate );
+    //! Ends the note in progress, call it after the last hop.
+    void    finish();
+    void    clear();
+
+    //! Pitch of each completed note as a fractional MIDI note, the median of its hops.
+    const std::vector<float>&   getNotes() const    { return mNotes; }
+    //! Semitones from each note to the next, one less than getNotes().
+    std::vector<float>          getIntervals() const;
+
+  private:
+    void    endNote();
+
+    Options             mOptions;
+    std::vector<float>  mNotes;
+    std::vector<float>  mNoteHops;      // pitches of the note in progress
+    float               mNoteSum;
+    size_t              mGapHops;
+};
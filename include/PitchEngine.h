@@ -0,0 +1,88 @@
+#pragma once
+
+#include "CepstralEstimator.h"
+#include "PitchEstimate.h"
+#include "YinEstimator.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//! Cheap-first pitch cascade. Every frame gets the zero-crossing / energy stage. The harmonic product spectrum
+//! over the existing magnitude spectrum only runs when that is ambiguous, the cepstrum (one inverse FFT) when the
+//! product is not confident, and YIN only when neither is or an onset just happened. Whichever stage is confident
+//! first resolves the frame.
+class PitchEngine {
+  public:
+    //! The stage that resolved a frame.
+    enum class Stage { SILENT, ZERO_CROSSING, SPECTRAL, CEPSTRAL, YIN, NUM_STAGES };
+
+    struct Options {
+        Options()
+            : mSilenceLevel( 0.001f ), mOnsetRatio( 2 ), mZeroCrossingMaxDeviation( 0.03f ), mHpsHarmonics( 4 ), mHpsMinBin( 8 ),
+                mHpsMinConfidence( 0.6f ), mCepstrumMinConfidence( 0.3f ), mYinThreshold( 0.15f )
+        {}
+
+        float   mSilenceLevel;              //!< RMS below which a frame is silent (linear, ~ -60 dB)
+        float   mOnsetRatio;                //!< RMS rise over the previous frame that counts as an onset and forces YIN
+        float   mZeroCrossingMaxDeviation;  //!< largest crossing interval deviation, relative to the mean, to accept the rate
+        size_t  mHpsHarmonics;              //!< spectra multiplied in the harmonic product
+        size_t  mHpsMinBin;                 //!< below this the spectrum is too coarse to resolve a pitch
+        float   mHpsMinConfidence;
+        float   mCepstrumMinConfidence;
+        float   mYinThreshold;
+    };
+
+    struct Result {
+        Result() : mStage( Stage::SILENT ), mOnset( false ) {}
+
+        PitchEstimate   mEstimate;
+        Stage           mStage;
+        bool            mOnset;
+    };
+
+    //! Frames resolved and time spent per stage, to compare against running YIN on every frame.
+    struct Stats {
+        Stats();
+
+        uint64_t    mNumFrames;
+        uint64_t    mNumResolved[(size_t)Stage::NUM_STAGES];    //!< frames each stage resolved
+        uint64_t    mNumRuns[(size_t)Stage::NUM_STAGES];        //!< frames each stage ran on
+        double      mSeconds[(size_t)Stage::NUM_STAGES];        //!< time spent in each stage
+
+        //! e.g. "1200 frames - silent 10%, zero crossing 35%, spectral 30%, cepstral 10%, yin 15% - 41 us/frame, yin alone 120 us"
+        std::string format() const;
+    };
+
+    PitchEngine( const Options &options = Options() );
+
+    //! \a raw holds the most recent samples at \a rawRate, at least 2 * maxLag of them; \a magSpectrum is the
+    //! frame's magnitude spectrum with \a binWidth hertz per bin, which \a fft produced from \a windowSize frames
+    //! (the cepstral stage is skipped without it). Lags bound the period search (see RateTables).
+    Result  process( const float *raw, size_t numRaw, float rawRate, size_t minLag, size_t maxLag,
+                     const float *magSpectrum, size_t numBins, float binWidth, size_t windowSize, ci::audio::dsp::Fft *fft );
+
+    //! Allocates everything process() needs for periods up to \a maxLag and spectra of \a numBins, so that not even
+    //! the first frames allocate (e.g. on a host's audio thread).
+    void            reserve( size_t maxLag, size_t numBins );
+
+    const Options&  getOptions() const      { return mOptions; }
+    void            setOptions( const Options &options );
+
+    const Stats&    getStats() const        { return mStats; }
+    void            resetStats()            { mStats = Stats(); }
+
+    static const char*  getStageName( Stage stage );
+
+  private:
+    bool    zeroCrossing( const float *raw, size_t numRaw, float rawRate, size_t minLag, size_t maxLag, PitchEstimate *estimate ) const;
+    bool    harmonicProduct( const float *magSpectrum, size_t numBins, float binWidth, float minFreq, float maxFreq, PitchEstimate *estimate );
+
+    Options             mOptions;
+    CepstralEstimator   mCepstrum;
+    YinEstimator        mYin;
+    std::vector<float>  mHps;
+    float               mLastRms;
+    Stats               mStats;
+};
@@ -0,0 +1,12 @@
+#pragma once
+
+//! Result of one pitch estimator for one window.
+struct PitchEstimate {
+    PitchEstimate() : mFreq( 0 ), mConfidence( 0 ) {}
+    PitchEstimate( float freq, float confidence ) : mFreq( freq ), mConfidence( confidence ) {}
+
+    bool    isVoiced() const    { return mFreq > 0; }
+
+    float   mFreq;          //!< hertz, 0 if no pitch was found
+    float   mConfidence;    //!< 0 - 1, estimator specific
+};
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "AnalysisConfig.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+//! Everything in the analysis that depends on the sample rate and FFT size, computed once per change and then
+//! shared read-only, so the per-frame code never derives rates itself. Rebuilt by AnalysisPipeline whenever the
+//! device format, the analyzer or the config changes.
+struct RateTables {
+    //! \a sampleRate is the analysis rate, \a deviceRate the rate of the raw samples (they differ when resampling).
+    RateTables( float sampleRate, float deviceRate, size_t fftSize, const AnalysisConfig &config );
+
+    float   getFreqForBin( float bin ) const    { return bin * mBinWidth; }
+    float   getBinForFreq( float freq ) const   { return freq / mBinWidth; }
+
+    //! Returns \a freq, half of it or twice it, whichever best fits a harmonic series in \a magSpectrum (mNumBins
+    //! entries). Looks up kNumHarmonics harmonics and the gaps between them for each of the three.
+    float   correctOctave( const float *magSpectrum, float freq ) const;
+
+    static const size_t kNumHarmonics = 8;
+    static const int    kStepsPerNote = 4;     //!< pitch resolution of mHarmonicBins, quarter semitones
+
+    float               mSampleRate;
+    float               mDeviceRate;
+    float               mNyquist;
+    size_t              mFftSize;
+    size_t              mNumBins;
+    float               mBinWidth;          //!< hertz per bin
+    std::vector<float>  mBinFreqs;          //!< hertz at the start of each bin, mNumBins entries
+    float               mCentroidDivisor;   //!< sample rate / config centroid factor ("MyQuisp")
+    size_t              mMinLag, mMaxLag;   //!< pitch period range in analysis rate samples, for the config's max / min pitch
+    //! For each pitch step from MIDI note 0, the nearest bins of 0.5, 1, 1.5 .. kNumHarmonics times its frequency
+    //! (2 * kNumHarmonics entries per step), mNumBins where that is past nyquist.
+    std::vector<uint32_t>   mHarmonicBins;
+};
+
+typedef std::shared_ptr<const RateTables> RateTablesRef;
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "cinder/audio/Node.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+//! Pass-through node that broadcasts the input, mixed down to mono, through a lock-free ring. The audio thread
+//! never waits: it writes and publishes a position. Any number of consumers read through their own Reader, each
+//! with its own cursor. Every sample is stored twice (at i and i + capacity), so any window up to the capacity is
+//! one contiguous, aligned run that estimators read in place, at any hop.
+class RawSampleTap : public ci::audio::Node {
+  public:
+    //! \a capacity is rounded up to a power of two.
+    RawSampleTap( const Format &format = Format(), size_t capacity = 16384 );
+
+    //! One consumer's view of the ring. Readers are independent, cheap to copy and never block the writer. A window
+    //! returned by next() or latest() is only guaranteed intact if isValid() is still true after it was used.
+    class Reader {
+      public:
+        Reader() : mTap( nullptr ), mCursor( 0 ), mWindowStart( 0 ), mNumDropped( 0 ) {}
+
+        //! The \a windowSize frames starting at the cursor, which then advances by \a hop. Null until enough new
+        //! frames were written. A reader that fell behind by more than the ring holds skips ahead (see getNumDropped()).
+        const float*    next( size_t windowSize, size_t hop );
+        //! The most recent \a windowSize frames, leaving the cursor after them. Null until that many were written.
+        const float*    latest( size_t windowSize );
+        //! False if the writer may have overwritten the last returned window while it was being read.
+        bool            isValid() const;
+
+        //! Stream position (in frames) of the last returned window's first frame.
+        uint64_t        getWindowStart() const  { return mWindowStart; }
+        uint64_t        getNumDropped() const   { return mNumDropped; }
+
+      private:
+        Reader( const RawSampleTap *tap, uint64_t cursor ) : mTap( tap ), mCursor( cursor ), mWindowStart( cursor ), mNumDropped( 0 ) {}
+
+        const RawSampleTap  *mTap;
+        uint64_t            mCursor, mWindowStart, mNumDropped;
+
+        friend class RawSampleTap;
+    };
+
+    //! A reader starting at the current write position. The tap has to outlive it.
+    Reader      createReader() const    { return Reader( this, getWritePosition() ); }
+
+    //! Total frames written since the tap was created.
+    uint64_t    getWritePosition() const    { return mWritePosition.load( std::memory_order_acquire ); }
+    size_t      getCapacity() const         { return mCapacity; }
+    //! Largest window a Reader can return, the capacity less the frames the writer may be filling.
+    size_t      getMaxWindowSize() const    { return mCapacity - std::min( getGuard(), mCapacity ); }
+
+  protected:
+    void process( ci::audio::Buffer *buffer ) override;
+
+  private:
+    //! Frames a reader keeps away from the write position, the writer may be filling them.
+    size_t          getGuard() const;
+    const float*    getFrames( uint64_t position ) const    { return mData + ( position & ( mCapacity - 1 ) ); }
+
+    size_t                      mCapacity;
+    std::unique_ptr<float[]>    mStorage;
+    float                       *mData;         // mStorage aligned to 32 bytes, 2 * mCapacity frames
+    std::atomic<uint64_t>       mWritePosition;
+};
+
+typedef std::shared_ptr<RawSampleTap> RawSampleTapRef;
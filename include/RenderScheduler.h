@@ -0,0 +1,45 @@
+#pragma once
+
+//! Decides how often the app needs to tick. In Mode::ON_DEMAND the loop runs at the configured cap only
+//! while the analysis is publishing new frames with signal in them, or while an animation is running,
+//! and drops to a low idle rate otherwise. Mode::CONTINUOUS always runs at the cap. The app takes both rates from
+//! AnalysisConfig ("maxFrameRate", "idleFrameRate").
+class RenderScheduler {
+  public:
+    enum class Mode { CONTINUOUS, ON_DEMAND };
+
+    struct Options {
+        Options()
+            : mMaxFrameRate( 60 ), mIdleFrameRate( 5 ), mSilenceThreshold( 10 ), mSilenceHold( 1.0 )
+        {}
+
+        float   mMaxFrameRate;      //!< cap while there is something to show
+        float   mIdleFrameRate;     //!< rate while idle, this bounds how late the first active frame is
+        float   mSilenceThreshold;  //!< input level (decibels, linear) below which the input counts as silent
+        double  mSilenceHold;       //!< seconds of silence before idling, so decays and releases still render
+    };
+
+    RenderScheduler( Mode mode = Mode::ON_DEMAND, const Options &options = Options() );
+
+    void            setMode( Mode mode )        { mMode = mode; }
+    Mode            getMode() const             { return mMode; }
+    void            setOptions( const Options &options )    { mOptions = options; }
+    const Options&  getOptions() const          { return mOptions; }
+
+    //! Call once per tick, with whether the analysis published a new frame since the last tick and its input level.
+    void update( double currentTime, bool newAnalysisFrame, float inputLevel );
+    //! Keeps the loop at the full rate for \a seconds, for animations that run without new analysis frames.
+    void requestAnimation( double seconds );
+    //! Wakes the loop for a user event (input, resize), same as a short animation.
+    void wake()     { requestAnimation( 0.25 ); }
+
+    bool    isIdle() const                  { return mIdle; }
+    //! The frame rate the app should currently be ticking at.
+    float   getTargetFrameRate() const;
+
+  private:
+    Mode        mMode;
+    Options     mOptions;
+    double      mCurrentTime, mLastSignalTime, mAnimationEndTime;
+    bool        mIdle;
+};
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+//! Polyphase windowed-sinc (Kaiser) resampler for arbitrary rate ratios. It converts the most recent stretch of a
+//! mono signal, so it needs no state between calls and can run directly on a monitor's window.
+class Resampler {
+  public:
+    //! \a zeroCrossings per side of the sinc at the output rate (the filter's quality), \a numPhases sub-sample
+    //! positions in the coefficient table.
+    Resampler( size_t zeroCrossings = 16, size_t numPhases = 256 );
+
+    //! Rebuilds the coefficient table if the ratio changed. The cutoff sits just below the lower of the two nyquists.
+    void setRates( float sourceRate, float targetRate );
+
+    float   getSourceRate() const   { return mSourceRate; }
+    float   getTargetRate() const   { return mTargetRate; }
+    //! True if the rates match and process() would only copy.
+    bool    isBypassed() const      { return mSourceRate == mTargetRate; }
+
+    //! Number of output frames that \a numSourceFrames fully cover.
+    size_t  getNumOutputFrames( size_t numSourceFrames ) const;
+    //! Number of source frames needed to cover \a numOutputFrames, the inverse of getNumOutputFrames().
+    size_t  getNumSourceFrames( size_t numOutputFrames ) const;
+
+    //! Resamples the end of \a source into \a dest, the last output frame lining up with the most recent source frame
+    //! the filter can fully cover (getDelay() frames before the end).
+    void    processTail( const float *source, size_t numSourceFrames, float *dest, size_t numDestFrames ) const;
+
+    //! Source frames between the last output frame and the end of the source.
+    size_t  getDelay() const        { return mNumTaps / 2; }
+
+  private:
+    size_t              mZeroCrossings, mNumPhases;
+    float               mSourceRate, mTargetRate;
+    size_t              mNumTaps;
+    std::vector<float>  mTable;     // mNumPhases + 1 rows of mNumTaps coefficients
+};
@@ -0,0 +1,24 @@
+#pragma once
+
+#include "cinder/Rect.h"
+#include "cinder/Vector.h"
+
+//! Screen-space placement of everything the app draws, derived from the window size alone. It is recomputed
+//! on resize and never per frame; analysis values (bins, hertz, decibels) are only mapped through it when drawing.
+struct SceneLayout {
+    SceneLayout();
+    explicit SceneLayout( const ci::ivec2 &windowSize );
+
+    //! Maps a magnitude in decibels (0 - 100) to a y position inside the plot.
+    float getPlotY( float decibels ) const  { return mPlotBounds.y2 - decibels * mPlotDecibelScale; }
+
+    ci::vec2    mWindowSize, mCenter;
+    ci::Rectf   mPlotBounds;
+    float       mPlotDecibelScale;  // plot height per decibel
+    float       mShapeScale;        // relative to the 1024 x 768 window the shapes were designed at
+
+    // pitch band indicators, low / mid / high
+    ci::vec2    mLowBandPos, mMidBandPos, mHighBandPos;
+    // spectral centroid indicators
+    ci::vec2    mCentroidPos, mCentroidRightPos, mCentroidLeftPos;
+};
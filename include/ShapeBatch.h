@@ -0,0 +1,40 @@
+#pragma once
+
+#include "cinder/gl/Batch.h"
+#include "cinder/gl/Vbo.h"
+#include "cinder/Color.h"
+#include "cinder/Rect.h"
+
+#include <vector>
+
+//! Collects the reactive shapes for a frame and draws them all with a single instanced draw call.
+//! Each shape is a quad whose edge is computed in the fragment shader from a rounded-box signed distance
+//! field, so circles and rectangles share one shader and no circle geometry is rebuilt per frame.
+class ShapeBatch {
+  public:
+    ShapeBatch();
+
+    void addCircle( const ci::vec2 &center, float radius, const ci::ColorA &color );
+    void addRect( const ci::Rectf &rect, const ci::ColorA &color );
+
+    //! Draws every shape added since the last call, then clears the batch.
+    void draw();
+
+    size_t getNumShapes() const    { return mInstances.size(); }
+
+  private:
+    struct Instance {
+        ci::vec4    mCenterHalfSize;    // xy: center, zw: half extents
+        ci::vec4    mColor;
+        float       mCornerRadius;
+    };
+
+    void addInstance( const ci::vec2 &center, const ci::vec2 &halfSize, float cornerRadius, const ci::ColorA &color );
+    void allocate( size_t capacity );
+
+    std::vector<Instance>   mInstances;
+    size_t                  mCapacity;
+    ci::gl::GlslProgRef     mGlsl;
+    ci::gl::VboRef          mInstanceVbo;
+    ci::gl::BatchRef        mBatch;
+};
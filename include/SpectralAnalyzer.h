@@ -0,0 +1,65 @@
+#pragma once
+
+#include "cinder/audio/Buffer.h"
+#include "cinder/audio/dsp/Dsp.h"
+#include "cinder/audio/dsp/Fft.h"
+
+#include <memory>
+#include <vector>
+
+//! Windowed, zero-padded FFT magnitude analysis - the same computation audio::MonitorSpectralNode does, but
+//! outside the audio graph, so the resolution can change without touching the graph or the audio thread.
+class SpectralAnalyzer {
+  public:
+    struct Format {
+        Format()
+            : mFftSize( 2048 ), mWindowSize( 1024 ), mWindowType( ci::audio::dsp::WindowType::BLACKMAN ), mSmoothingFactor( 0.5f )
+        {}
+
+        //! FFT size, rounded up to a power of two no smaller than the window size.
+        Format& fftSize( size_t size )                          { mFftSize = size; return *this; }
+        //! Number of most recent frames analyzed. Defaults to the FFT size if 0.
+        Format& windowSize( size_t size )                       { mWindowSize = size; return *this; }
+        Format& windowType( ci::audio::dsp::WindowType type )   { mWindowType = type; return *this; }
+        //! Weight of the previous spectrum in each new one, 0 - 1.
+        Format& smoothingFactor( float factor )                 { mSmoothingFactor = factor; return *this; }
+
+        size_t                      mFftSize;
+        size_t                      mWindowSize;
+        ci::audio::dsp::WindowType  mWindowType;
+        float                       mSmoothingFactor;
+    };
+
+    //! Allocates the FFT plan, windowing table and buffers, so it can be prepared on any thread.
+    explicit SpectralAnalyzer( const Format &format = Format() );
+
+    //! Analyzes the last getWindowSize() frames of \a buffer, mixing its channels down to mono.
+    void process( const ci::audio::Buffer &buffer );
+    //! Analyzes the last getWindowSize() of \a numFrames mono \a samples.
+    void process( const float *samples, size_t numFrames );
+
+    const std::vector<float>&   getMagSpectrum() const  { return mMagSpectrum; }
+    //! RMS of the last analyzed window, linear.
+    float                       getRms() const          { return mRms; }
+
+    const Format&   getFormat() const       { return mFormat; }
+    size_t          getFftSize() const      { return mFormat.mFftSize; }
+    size_t          getWindowSize() const   { return mFormat.mWindowSize; }
+    size_t          getNumBins() const      { return mMagSpectrum.size(); }
+    //! The FFT plan, for estimators that transform the spectrum again. Use it on the thread that calls process().
+    ci::audio::dsp::Fft*    getFft() const  { return mFft.get(); }
+
+  private:
+    //! Windows, transforms and smooths the samples in mWindowBuffer.
+    void analyzeWindow();
+
+    Format                                  mFormat;
+    std::unique_ptr<ci::audio::dsp::Fft>    mFft;
+    std::vector<float>                      mWindowingTable;
+    ci::audio::Buffer                       mWindowBuffer;
+    ci::audio::BufferSpectral               mSpectralBuffer;
+    std::vector<float>                      mMagSpectrum;
+    float                                   mRms;
+};
+
+typedef std::shared_ptr<SpectralAnalyzer> SpectralAnalyzerRef;
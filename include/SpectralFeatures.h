@@ -0,0 +1,22 @@
+#pragma once
+
+#include "AnalysisConfig.h"
+#include "RateTables.h"
+#include "SpectralAnalyzer.h"
+
+//! The scalar readings of one analyzed window: level, spectral centroid and the centroid's pitch mapping. These are
+//! the values AnalysisPipeline crossfades while switching analyzers, and BlockAnalyzer reports the same ones.
+struct SpectralFeatures {
+    SpectralFeatures()
+        : mSpectralCentroid( 0 ), mInputLevel( 0 ), mPitchBin( 0 ), mPitchFreq( 0 ), mPitchLevel( 0 )
+    {}
+
+    //! Reads \a analyzer's last window through \a tables, which have to match its FFT size.
+    static SpectralFeatures measure( const SpectralAnalyzer &analyzer, const RateTables &tables, const AnalysisConfig &config );
+
+    float mSpectralCentroid;    //!< hertz
+    float mInputLevel;          //!< RMS, decibels (0 - 100)
+    float mPitchBin;            //!< fractional bin
+    float mPitchFreq;           //!< hertz
+    float mPitchLevel;          //!< magnitude at mPitchBin, decibels (0 - 100)
+};
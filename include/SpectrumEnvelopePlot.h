@@ -0,0 +1,60 @@
+#pragma once
+
+#include "FrequencyAxis.h"
+
+#include "cinder/gl/Batch.h"
+#include "cinder/gl/Vbo.h"
+#include "cinder/Color.h"
+#include "cinder/Rect.h"
+
+#include <vector>
+
+//! Per-column reduction of a magnitude spectrum, in linear magnitude.
+struct SpectrumEnvelope {
+    std::vector<float>  mMin, mMax, mMean;
+};
+
+//! Reduces \a magSpectrum to one min / max / mean triple per column of \a axis, in a single pass over the bins.
+void reduceSpectrum( const float *magSpectrum, const FrequencyAxis &axis, SpectrumEnvelope *result );
+
+//! Draws a magnitude spectrum decimated to the plot's pixel width, so the vertex count depends on
+//! the plot size rather than the FFT size. The vertices live in one buffer that is rewritten in place each
+//! frame and only reallocated when the width changes. Drop-in replacement for SpectrumPlot.
+class SpectrumEnvelopePlot {
+  public:
+    SpectrumEnvelopePlot();
+
+    void setBounds( const ci::Rectf &bounds )       { mBounds = bounds; }
+    const ci::Rectf& getBounds() const              { return mBounds; }
+
+    void setBorderEnabled( bool enable = true )     { mBorderEnabled = enable; }
+    bool isBorderEnabled() const                    { return mBorderEnabled; }
+    void setBorderColor( const ci::ColorA &color )  { mBorderColor = color; }
+
+    void setScale( FrequencyAxis::Scale scale )     { mScale = scale; }
+    FrequencyAxis::Scale getScale() const           { return mScale; }
+
+    const FrequencyAxis& getAxis() const            { return mAxis; }
+
+    void draw( const std::vector<float> &magSpectrum, float nyquist );
+
+  private:
+    struct Vertex {
+        ci::vec2    mPosition;
+        ci::vec4    mColor;
+    };
+
+    void allocate( size_t numColumns );
+
+    ci::Rectf               mBounds;
+    bool                    mBorderEnabled;
+    ci::ColorA              mBorderColor;
+    FrequencyAxis::Scale    mScale;
+    FrequencyAxis           mAxis;
+    SpectrumEnvelope        mEnvelope;
+
+    std::vector<Vertex>     mVertices;          // fill strip, band strip, then the mean line
+    size_t                  mNumColumns;        // the buffers were allocated for
+    ci::gl::VboRef          mVbo;
+    ci::gl::BatchRef        mFillBatch, mBandBatch, mMeanBatch;
+};
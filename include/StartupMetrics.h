@@ -0,0 +1,28 @@
+#pragma once
+
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+//! Records how long after process launch each startup milestone was first reached ("audio_ready",
+//! "first_draw", "first_pitch", ...), so startup time can be tracked and regressed against.
+class StartupMetrics {
+  public:
+    static StartupMetrics& instance();
+
+    //! Records \a milestone the first time it is reached, later calls are ignored. Thread safe.
+    void mark( const std::string &milestone );
+    bool hasMark( const std::string &milestone ) const;
+    //! Milliseconds between launch and \a milestone, or -1 if it hasn't been reached.
+    double getMilliseconds( const std::string &milestone ) const;
+
+    //! All milestones in the order they were reached, as a single line: "startup: audio_ready=12.3ms first_draw=..."
+    std::string format() const;
+
+  private:
+    StartupMetrics() {}
+
+    mutable std::mutex                          mMutex;
+    std::vector<std::pair<std::string, double>> mMarks;
+};
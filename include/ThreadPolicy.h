@@ -0,0 +1,40 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+//! Scheduling requested for one of the app's threads. The default requests nothing and leaves the thread as is.
+struct ThreadPolicy {
+    ThreadPolicy() : mRealtime( false ), mPriority( 0 ) {}
+
+    bool    isDefault() const   { return ! mRealtime && mPriority == 0 && mCpus.empty(); }
+    bool    operator==( const ThreadPolicy &other ) const   { return mRealtime == other.mRealtime && mPriority == other.mPriority && mCpus == other.mCpus; }
+    bool    operator!=( const ThreadPolicy &other ) const   { return ! ( *this == other ); }
+
+    bool                mRealtime;  //!< SCHED_FIFO on POSIX, time critical priority on Windows
+    int                 mPriority;  //!< SCHED_FIFO priority (1 - 99), ignored on Windows
+    std::vector<int>    mCpus;      //!< cores the thread may run on, empty for any
+};
+
+//! Outcome of applyThreadPolicy(). Plain values, so it can be filled in on the audio thread and reported elsewhere.
+struct ThreadPolicyResult {
+    ThreadPolicyResult() : mRealtimeRequested( false ), mAffinityRequested( false ), mRealtimeError( 0 ), mAffinityError( 0 ) {}
+
+    //! errno codes on POSIX (EPERM when denied), GetLastError() codes on Windows, kUnsupported if the platform has no
+    //! such control, 0 on success.
+    static const int kUnsupported = -1;
+
+    bool        isDenied() const    { return mRealtimeError != 0 || mAffinityError != 0; }
+    //! e.g. "realtime denied (Operation not permitted), affinity ok", parts the policy didn't ask for are "not requested"
+    std::string describe() const;
+
+    bool    mRealtimeRequested, mAffinityRequested;
+    int     mRealtimeError;
+    int     mAffinityError;
+};
+
+//! Applies \a policy to the calling thread. Makes system calls but doesn't allocate, so it is safe on the audio thread.
+ThreadPolicyResult applyThreadPolicy( const ThreadPolicy &policy );
+//! applyThreadPolicy() for the device callback's thread. On macOS the realtime request is reported as unsupported
+//! rather than made, CoreAudio already schedules its IO thread with a time constraint policy.
+ThreadPolicyResult applyAudioThreadPolicy( const ThreadPolicy &policy );
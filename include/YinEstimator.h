@@ -0,0 +1,26 @@
+#pragma once
+
+#include "PitchEstimate.h"
+
+#include <cstddef>
+#include <vector>
+
+//! YIN (de Cheveigné & Kawahara, 2002) on raw samples: cumulative mean normalized difference, absolute threshold,
+//! parabolic refinement. Confidence is 1 - the normalized difference at the chosen period.
+class YinEstimator {
+  public:
+    YinEstimator( float threshold = 0.15f );
+
+    //! Searches periods of \a minLag - \a maxLag frames in \a samples, which needs more than 2 * maxLag frames.
+    PitchEstimate estimate( const float *samples, size_t numSamples, float sampleRate, size_t minLag, size_t maxLag );
+
+    //! Allocates for periods up to \a maxLag, so estimate() doesn't allocate.
+    void    reserve( size_t maxLag )            { mDifference.reserve( maxLag + 2 ); }
+
+    void    setThreshold( float threshold )     { mThreshold = threshold; }
+    float   getThreshold() const                { return mThreshold; }
+
+  private:
+    float               mThreshold;
+    std::vector<float>  mDifference;    // cumulative mean normalized, indexed by lag
+};
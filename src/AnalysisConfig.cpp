@@ -0,0 +1,334 @@
+#include "AnalysisConfig.h"
+
+#include "cinder/Log.h"
+#include "cinder/Utilities.h"
+
+#include <algorithm>
+#include <cmath>
+#include <initializer_list>
+#include <iterator>
+
+using namespace ci;
+using namespace std;
+
+namespace {
+
+const char *sSlotNames[] = { "low", "mid", "high" };
+
+const pair<const char *, audio::dsp::WindowType> sWindowTypes[] = {
+    { "blackman", audio::dsp::WindowType::BLACKMAN },
+    { "hamming", audio::dsp::WindowType::HAMM },
+    { "hann", audio::dsp::WindowType::HANN },
+    { "rect", audio::dsp::WindowType::RECT }
+};
+
+// a misspelled key would otherwise keep its default without a word
+void warnUnknownKeys( const JsonTree &json, const string &where, initializer_list<const char *> known )
+{
+    for( const auto &child : json ) {
+        const string &key = child.getKey();
+        if( none_of( known.begin(), known.end(), [&key]( const char *name ) { return key == name; } ) )
+            CI_LOG_W( "ignoring unknown config key: " << ( where.empty() ? key : where + "." + key ) );
+    }
+}
+
+float getFloat( const JsonTree &json, const string &key, float defaultValue )
+{
+    return json.hasChild( key ) ? json.getValueForKey<float>( key ) : defaultValue;
+}
+
+SpectralAnalyzer::Format parseFormat( const JsonTree &json, SpectralAnalyzer::Format format, const string &where )
+{
+    warnUnknownKeys( json, where, { "fftSize", "windowSize", "windowType", "smoothing" } );
+    format.mFftSize = (size_t)getFloat( json, "fftSize", (float)format.mFftSize );
+    format.mWindowSize = (size_t)getFloat( json, "windowSize", (float)format.mWindowSize );
+    format.mSmoothingFactor = getFloat( json, "smoothing", format.mSmoothingFactor );
+
+    if( json.hasChild( "windowType" ) ) {
+        string name = json.getValueForKey<string>( "windowType" );
+        auto type = find_if( begin( sWindowTypes ), end( sWindowTypes ), [&name]( const pair<const char *, audio::dsp::WindowType> &entry ) { return name == entry.first; } );
+        if( type == end( sWindowTypes ) )
+            throw AnalysisConfigExc( where + ".windowType must be blackman, hamming, hann or rect" );
+        format.mWindowType = type->second;
+    }
+
+    if( format.mFftSize < 64 || format.mFftSize > 32768 || ( format.mFftSize & ( format.mFftSize - 1 ) ) != 0 )
+        throw AnalysisConfigExc( where + ".fftSize must be a power of two between 64 and 32768" );
+    if( format.mWindowSize == 0 || format.mWindowSize > format.mFftSize )
+        throw AnalysisConfigExc( where + ".windowSize must be between 1 and fftSize" );
+    if( format.mWindowSize > AnalysisConfig::kMaxWindowSize )
+        throw AnalysisConfigExc( where + ".windowSize must be at most " + to_string( AnalysisConfig::kMaxWindowSize ) );
+    if( format.mSmoothingFactor < 0 || format.mSmoothingFactor > 1 )
+        throw AnalysisConfigExc( where + ".smoothing must be between 0 and 1" );
+
+    return format;
+}
+
+JsonTree formatToJson( const string &key, const SpectralAnalyzer::Format &format )
+{
+    JsonTree json = JsonTree::makeObject( key );
+    json.addChild( JsonTree( "fftSize", (int)format.mFftSize ) );
+    json.addChild( JsonTree( "windowSize", (int)format.mWindowSize ) );
+    for( const auto &entry : sWindowTypes ) {
+        if( entry.second == format.mWindowType )
+            json.addChild( JsonTree( "windowType", string( entry.first ) ) );
+    }
+    json.addChild( JsonTree( "smoothing", format.mSmoothingFactor ) );
+    return json;
+}
+
+ThreadPolicy parseThreadPolicy( const JsonTree &json, const string &where )
+{
+    warnUnknownKeys( json, where, { "realtime", "priority", "cpus" } );
+
+    ThreadPolicy policy;
+    if( json.hasChild( "realtime" ) )
+        policy.mRealtime = json.getValueForKey<bool>( "realtime" );
+
+    policy.mPriority = (int)getFloat( json, "priority", 0 );
+    if( policy.mPriority < 0 || policy.mPriority > 99 )
+        throw AnalysisConfigExc( where + ".priority must be between 0 and 99" );
+
+    if( json.hasChild( "cpus" ) ) {
+        for( const auto &cpu : json.getChild( "cpus" ) ) {
+            int index = cpu.getValue<int>();
+            if( index < 0 || index >= 64 )
+                throw AnalysisConfigExc( where + ".cpus must be core indices between 0 and 63" );
+            policy.mCpus.push_back( index );
+        }
+    }
+
+    return policy;
+}
+
+JsonTree threadPolicyToJson( const string &key, const ThreadPolicy &policy )
+{
+    JsonTree json = JsonTree::makeObject( key );
+    json.addChild( JsonTree( "realtime", policy.mRealtime ) );
+    json.addChild( JsonTree( "priority", policy.mPriority ) );
+
+    JsonTree cpus = JsonTree::makeArray( "cpus" );
+    for( int cpu : policy.mCpus )
+        cpus.pushBack( JsonTree( "", cpu ) );
+    json.addChild( cpus );
+    return json;
+}
+
+PitchTrigger makeTrigger( const string &name, PitchTrigger::Slot slot, float minFreq, float maxFreq, const ColorA &color )
+{
+    PitchTrigger trigger;
+    trigger.mName = name;
+    trigger.mSlot = slot;
+    if( minFreq > 0 )
+        trigger.mMinFreq = minFreq;
+    if( maxFreq > 0 )
+        trigger.mMaxFreq = maxFreq;
+    trigger.mColor = color;
+    return trigger;
+}
+
+} // anonymous namespace
+
+AnalysisConfig::AnalysisConfig()
+    : mCentroidFactor( 0.745f ), mReferenceWidth( 1024 ), mPitchThreshold( 10 ), mAnalysisRate( 0 ), mMinPitch( 40 ), mMaxPitch( 2000 ), mOctaveCorrection( true ), mTunerReference( 440 ),
+        mMaxFrameRate( 60 ), mIdleFrameRate( 5 )
+{
+    // By providing an FFT size double that of the window size, we 'zero-pad' the analysis data, which gives
+    // an increase in resolution of the resulting spectrum data.
+    mAnalysis = SpectralAnalyzer::Format().fftSize( 2048 ).windowSize( 1024 );
+
+    mPresets["fast"] = SpectralAnalyzer::Format().fftSize( 1024 ).windowSize( 512 );
+    mPresets["default"] = mAnalysis;
+    mPresets["bass"] = SpectralAnalyzer::Format().fftSize( 8192 ).windowSize( 4096 );
+
+    // the guitar bands: low e and mid a, below that, and above
+    mTriggers.push_back( makeTrigger( "mid", PitchTrigger::Slot::MID, 200, 400, ColorA( 1, 0, 0 ) ) );
+    mTriggers.push_back( makeTrigger( "low", PitchTrigger::Slot::LOW, 0, 200, ColorA( 0, 1, 0 ) ) );
+    mTriggers.push_back( makeTrigger( "high", PitchTrigger::Slot::HIGH, 400, 0, ColorA( 0, 0, 1 ) ) );
+}
+
+AnalysisConfigRef AnalysisConfig::create( const JsonTree &json )
+{
+    auto config = make_shared<AnalysisConfig>();
+
+    try {
+        warnUnknownKeys( json, "", { "analysis", "preset", "presets", "inputDevice", "backupInputDevice", "centroidFactor", "referenceWidth",
+                                     "pitchThreshold", "analysisRate", "minPitch", "maxPitch", "octaveCorrection", "tunerReference",
+                                     "maxFrameRate", "idleFrameRate", "triggers", "threads" } );
+
+        if( json.hasChild( "presets" ) ) {
+            config->mPresets.clear();
+            for( const auto &preset : json.getChild( "presets" ) )
+                config->mPresets[preset.getKey()] = parseFormat( preset, SpectralAnalyzer::Format(), "presets." + preset.getKey() );
+        }
+
+        if( json.hasChild( "analysis" ) )
+            config->mAnalysis = parseFormat( json.getChild( "analysis" ), config->mAnalysis, "analysis" );
+
+        // a preset replaces the analysis block
+        if( json.hasChild( "preset" ) ) {
+            config->mPreset = json.getValueForKey<string>( "preset" );
+            auto presetIt = config->mPresets.find( config->mPreset );
+            if( presetIt == config->mPresets.end() )
+                throw AnalysisConfigExc( "unknown preset: " + config->mPreset );
+
+            config->mAnalysis = presetIt->second;
+        }
+
+        if( json.hasChild( "inputDevice" ) )
+            config->mInputDevice = json.getValueForKey<string>( "inputDevice" );
+        if( json.hasChild( "backupInputDevice" ) )
+            config->mBackupInputDevice = json.getValueForKey<string>( "backupInputDevice" );
+
+        config->mCentroidFactor = getFloat( json, "centroidFactor", config->mCentroidFactor );
+        config->mReferenceWidth = getFloat( json, "referenceWidth", config->mReferenceWidth );
+        config->mPitchThreshold = getFloat( json, "pitchThreshold", config->mPitchThreshold );
+        if( config->mCentroidFactor <= 0 || config->mReferenceWidth <= 0 )
+            throw AnalysisConfigExc( "centroidFactor and referenceWidth must be positive" );
+
+        config->mAnalysisRate = getFloat( json, "analysisRate", config->mAnalysisRate );
+        if( config->mAnalysisRate != 0 && ( config->mAnalysisRate < 8000 || config->mAnalysisRate > 192000 ) )
+            throw AnalysisConfigExc( "analysisRate must be 0 (device rate) or between 8000 and 192000" );
+
+        config->mMinPitch = getFloat( json, "minPitch", config->mMinPitch );
+        config->mMaxPitch = getFloat( json, "maxPitch", config->mMaxPitch );
+        if( config->mMinPitch <= 0 || config->mMinPitch >= config->mMaxPitch )
+            throw AnalysisConfigExc( "minPitch must be positive and below maxPitch" );
+        if( config->mMinPitch < kLowestPitch )
+            throw AnalysisConfigExc( "minPitch must be at least " + to_string( kLowestPitch ) + " hertz" );
+        if( config->mAnalysisRate != 0 && config->mMaxPitch >= config->mAnalysisRate / 2 )
+            throw AnalysisConfigExc( "maxPitch must be below the analysis rate's nyquist" );
+
+        if( json.hasChild( "octaveCorrection" ) )
+            config->mOctaveCorrection = json.getValueForKey<bool>( "octaveCorrection" );
+
+        config->mTunerReference = getFloat( json, "tunerReference", config->mTunerReference );
+        if( config->mTunerReference < 400 || config->mTunerReference > 480 )
+            throw AnalysisConfigExc( "tunerReference must be between 400 and 480 hertz" );
+
+        config->mMaxFrameRate = getFloat( json, "maxFrameRate", config->mMaxFrameRate );
+        config->mIdleFrameRate = getFloat( json, "idleFrameRate", config->mIdleFrameRate );
+        if( config->mMaxFrameRate < 1 || config->mMaxFrameRate > 240 )
+            throw AnalysisConfigExc( "maxFrameRate must be between 1 and 240" );
+        if( config->mIdleFrameRate <= 0 || config->mIdleFrameRate > config->mMaxFrameRate )
+            throw AnalysisConfigExc( "idleFrameRate must be positive and at most maxFrameRate" );
+
+        if( json.hasChild( "triggers" ) ) {
+            config->mTriggers.clear();
+            for( const auto &entry : json.getChild( "triggers" ) ) {
+                PitchTrigger trigger;
+                trigger.mName = entry.hasChild( "name" ) ? entry.getValueForKey<string>( "name" ) : "trigger " + to_string( config->mTriggers.size() );
+                warnUnknownKeys( entry, "trigger '" + trigger.mName + "'", { "name", "slot", "minFreq", "maxFreq", "minLevel", "color" } );
+                trigger.mMinFreq = getFloat( entry, "minFreq", trigger.mMinFreq );
+                trigger.mMaxFreq = getFloat( entry, "maxFreq", trigger.mMaxFreq );
+                trigger.mMinLevel = getFloat( entry, "minLevel", config->mPitchThreshold );
+                if( trigger.mMinFreq >= trigger.mMaxFreq )
+                    throw AnalysisConfigExc( "trigger '" + trigger.mName + "': minFreq must be below maxFreq" );
+
+                string slot = entry.hasChild( "slot" ) ? entry.getValueForKey<string>( "slot" ) : "mid";
+                size_t slotIndex = 0;
+                while( slotIndex < 3 && slot != sSlotNames[slotIndex] )
+                    slotIndex++;
+                if( slotIndex == 3 )
+                    throw AnalysisConfigExc( "trigger '" + trigger.mName + "': slot must be low, mid or high" );
+                trigger.mSlot = (PitchTrigger::Slot)slotIndex;
+
+                if( entry.hasChild( "color" ) ) {
+                    const JsonTree &color = entry.getChild( "color" );
+                    if( color.getNumChildren() < 3 )
+                        throw AnalysisConfigExc( "trigger '" + trigger.mName + "': color needs r, g, b" );
+
+                    float rgba[4] = { 1, 1, 1, 1 };
+                    size_t i = 0;
+                    for( auto it = color.begin(); it != color.end() && i < 4; ++it, ++i )
+                        rgba[i] = it->getValue<float>();
+                    trigger.mColor = ColorA( rgba[0], rgba[1], rgba[2], rgba[3] );
+                }
+
+                config->mTriggers.push_back( trigger );
+            }
+        }
+
+        if( json.hasChild( "threads" ) ) {
+            const JsonTree &threads = json.getChild( "threads" );
+            warnUnknownKeys( threads, "threads", { "audio", "analysis", "render" } );
+            if( threads.hasChild( "audio" ) )
+                config->mAudioThread = parseThreadPolicy( threads.getChild( "audio" ), "threads.audio" );
+            if( threads.hasChild( "analysis" ) )
+                config->mAnalysisThread = parseThreadPolicy( threads.getChild( "analysis" ), "threads.analysis" );
+            if( threads.hasChild( "render" ) )
+                config->mRenderThread = parseThreadPolicy( threads.getChild( "render" ), "threads.render" );
+        }
+    }
+    catch( AnalysisConfigExc & ) {
+        throw;
+    }
+    catch( std::exception &exc ) {
+        // wrong value types, mostly
+        throw AnalysisConfigExc( string( "invalid config: " ) + exc.what() );
+    }
+
+    return config;
+}
+
+JsonTree AnalysisConfig::toJson() const
+{
+    JsonTree json = JsonTree::makeObject();
+    json.addChild( formatToJson( "analysis", mAnalysis ) );
+    if( ! mPreset.empty() )
+        json.addChild( JsonTree( "preset", mPreset ) );
+
+    JsonTree presets = JsonTree::makeObject( "presets" );
+    for( const auto &preset : mPresets )
+        presets.addChild( formatToJson( preset.first, preset.second ) );
+    json.addChild( presets );
+
+    json.addChild( JsonTree( "inputDevice", mInputDevice ) );
+    json.addChild( JsonTree( "backupInputDevice", mBackupInputDevice ) );
+    json.addChild( JsonTree( "centroidFactor", mCentroidFactor ) );
+    json.addChild( JsonTree( "referenceWidth", mReferenceWidth ) );
+    json.addChild( JsonTree( "pitchThreshold", mPitchThreshold ) );
+    json.addChild( JsonTree( "analysisRate", mAnalysisRate ) );
+    json.addChild( JsonTree( "minPitch", mMinPitch ) );
+    json.addChild( JsonTree( "maxPitch", mMaxPitch ) );
+    json.addChild( JsonTree( "octaveCorrection", mOctaveCorrection ) );
+    json.addChild( JsonTree( "tunerReference", mTunerReference ) );
+    json.addChild( JsonTree( "maxFrameRate", mMaxFrameRate ) );
+    json.addChild( JsonTree( "idleFrameRate", mIdleFrameRate ) );
+
+    JsonTree triggers = JsonTree::makeArray( "triggers" );
+    for( const auto &trigger : mTriggers ) {
+        JsonTree entry = JsonTree::makeObject();
+        entry.addChild( JsonTree( "name", trigger.mName ) );
+        entry.addChild( JsonTree( "slot", string( sSlotNames[(int)trigger.mSlot] ) ) );
+        // unbounded ends are left out, JSON has no infinity
+        if( std::isfinite( trigger.mMinFreq ) )
+            entry.addChild( JsonTree( "minFreq", trigger.mMinFreq ) );
+        if( std::isfinite( trigger.mMaxFreq ) )
+            entry.addChild( JsonTree( "maxFreq", trigger.mMaxFreq ) );
+        entry.addChild( JsonTree( "minLevel", trigger.mMinLevel ) );
+
+        JsonTree color = JsonTree::makeArray( "color" );
+        color.pushBack( JsonTree( "", trigger.mColor.r ) );
+        color.pushBack( JsonTree( "", trigger.mColor.g ) );
+        color.pushBack( JsonTree( "", trigger.mColor.b ) );
+        color.pushBack( JsonTree( "", trigger.mColor.a ) );
+        entry.addChild( color );
+
+        triggers.pushBack( entry );
+    }
+    json.addChild( triggers );
+
+    JsonTree threads = JsonTree::makeObject( "threads" );
+    threads.addChild( threadPolicyToJson( "audio", mAudioThread ) );
+    threads.addChild( threadPolicyToJson( "analysis", mAnalysisThread ) );
+    threads.addChild( threadPolicyToJson( "render", mRenderThread ) );
+    json.addChild( threads );
+
+    return json;
+}
+
+fs::path AnalysisConfig::getDefaultPath()
+{
+    return getDocumentsDirectory() / "InputAnalyzer.json";
+}
@@ -0,0 +1,219 @@
+#include "AnalysisOutputs.h"
+#include "PitchEngine.h"
+
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+#if defined( _WIN32 )
+    #include <winsock2.h>
+    #include <ws2tcpip.h>
+    #include <windows.h>
+    #pragma comment( lib, "Ws2_32.lib" )
+    typedef int socklen_t;
+#else
+    #include <arpa/inet.h>
+    #include <fcntl.h>
+    #include <netdb.h>
+    #include <sys/mman.h>
+    #include <sys/socket.h>
+    #include <unistd.h>
+#endif
+
+using namespace std;
+
+namespace {
+
+void appendOscString( vector<uint8_t> *packet, const string &str )
+{
+    // null terminated, padded to a multiple of four bytes
+    packet->insert( packet->end(), str.begin(), str.end() );
+    size_t padding = 4 - str.size() % 4;
+    packet->insert( packet->end(), padding, 0 );
+}
+
+void appendOscFloat( vector<uint8_t> *packet, float value )
+{
+    uint32_t bits;
+    memcpy( &bits, &value, sizeof( bits ) );
+    packet->push_back( uint8_t( bits >> 24 ) );
+    packet->push_back( uint8_t( bits >> 16 ) );
+    packet->push_back( uint8_t( bits >> 8 ) );
+    packet->push_back( uint8_t( bits ) );
+}
+
+#if defined( _WIN32 )
+void closeSocket( intptr_t socket )    { closesocket( (SOCKET)socket ); }
+#else
+void closeSocket( intptr_t socket )    { close( (int)socket ); }
+#endif
+
+} // anonymous namespace
+
+// ----------------------------------------------------------------------------------------------------
+// LogOutput
+// ----------------------------------------------------------------------------------------------------
+
+LogOutput::LogOutput( float minLevel )
+    : mMinLevel( minLevel ), mLastFreq( 0 ), mLastEstimateFreq( 0 )
+{
+}
+
+void LogOutput::send( const AnalysisFrame &frame )
+{
+    float estimateFreq = frame.mEstimateFreq > 0 ? round( frame.mEstimateFreq ) : 0;
+    float freq = frame.mPitchLevel > mMinLevel ? round( frame.mPitchFreq ) : 0;
+    if( estimateFreq == mLastEstimateFreq && freq == mLastFreq )
+        return;
+
+    mLastEstimateFreq = estimateFreq;
+    mLastFreq = freq;
+    if( estimateFreq <= 0 && freq <= 0 ) {
+        printf( "silence\n" );
+        fflush( stdout );
+        return;
+    }
+
+    if( estimateFreq > 0 )
+        printf( "pitch: %.0f Hz (%s, confidence %.2f)", estimateFreq, PitchEngine::getStageName( (PitchEngine::Stage)frame.mEstimateStage ),
+                frame.mEstimateConfidence );
+    else
+        printf( "pitch: unvoiced" );
+
+    if( freq > 0 )
+        printf( ", centroid pitch: %.0f Hz at %.1f dB", freq, frame.mPitchLevel );
+
+    printf( ", centroid: %.0f Hz\n", frame.mSpectralCentroid );
+    fflush( stdout );
+}
+
+// ----------------------------------------------------------------------------------------------------
+// OscOutput
+// ----------------------------------------------------------------------------------------------------
+
+OscOutput::OscOutput( const string &host, uint16_t port, const string &address )
+    : mAddress( address ), mSocket( -1 )
+{
+#if defined( _WIN32 )
+    WSADATA wsaData;
+    WSAStartup( MAKEWORD( 2, 2 ), &wsaData );
+#endif
+
+    addrinfo hints = {};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_DGRAM;
+
+    addrinfo *result = nullptr;
+    if( getaddrinfo( host.c_str(), to_string( port ).c_str(), &hints, &result ) != 0 || ! result ) {
+        fprintf( stderr, "OscOutput: could not resolve %s\n", host.c_str() );
+        return;
+    }
+
+    intptr_t sock = (intptr_t)socket( result->ai_family, result->ai_socktype, result->ai_protocol );
+    if( sock >= 0 ) {
+        mSocket = sock;
+        const uint8_t *addr = reinterpret_cast<const uint8_t *>( result->ai_addr );
+        mDestination.assign( addr, addr + result->ai_addrlen );
+    }
+
+    freeaddrinfo( result );
+    mPacket.reserve( 64 );
+}
+
+OscOutput::~OscOutput()
+{
+    if( mSocket >= 0 )
+        closeSocket( mSocket );
+}
+
+void OscOutput::send( const AnalysisFrame &frame )
+{
+    if( mSocket < 0 )
+        return;
+
+    mPacket.clear();
+    appendOscString( &mPacket, mAddress );
+    appendOscString( &mPacket, ",ffff" );
+    appendOscFloat( &mPacket, frame.mPitchFreq );
+    appendOscFloat( &mPacket, frame.mPitchLevel );
+    appendOscFloat( &mPacket, frame.mSpectralCentroid );
+    appendOscFloat( &mPacket, frame.mInputLevel );
+
+    sendto( mSocket, reinterpret_cast<const char *>( mPacket.data() ), (int)mPacket.size(), 0,
+            reinterpret_cast<const sockaddr *>( mDestination.data() ), (socklen_t)mDestination.size() );
+}
+
+// ----------------------------------------------------------------------------------------------------
+// SharedMemoryOutput
+// ----------------------------------------------------------------------------------------------------
+
+SharedMemoryOutput::SharedMemoryOutput( const string &name )
+    : mName( name ), mState( nullptr ), mHandle( nullptr )
+{
+#if defined( _WIN32 )
+    HANDLE mapping = CreateFileMappingA( INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, 0, sizeof( SharedPitchState ), name.c_str() );
+    if( ! mapping ) {
+        fprintf( stderr, "SharedMemoryOutput: could not create %s\n", name.c_str() );
+        return;
+    }
+
+    mHandle = mapping;
+    mState = static_cast<SharedPitchState *>( MapViewOfFile( mapping, FILE_MAP_ALL_ACCESS, 0, 0, sizeof( SharedPitchState ) ) );
+#else
+    // POSIX names need a leading slash
+    if( mName.empty() || mName[0] != '/' )
+        mName = "/" + mName;
+
+    int fd = shm_open( mName.c_str(), O_CREAT | O_RDWR, 0644 );
+    if( fd < 0 || ftruncate( fd, sizeof( SharedPitchState ) ) != 0 ) {
+        fprintf( stderr, "SharedMemoryOutput: could not create %s\n", mName.c_str() );
+        if( fd >= 0 )
+            close( fd );
+        return;
+    }
+
+    void *addr = mmap( nullptr, sizeof( SharedPitchState ), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 );
+    close( fd );
+    if( addr != MAP_FAILED )
+        mState = static_cast<SharedPitchState *>( addr );
+#endif
+
+    if( mState )
+        memset( mState, 0, sizeof( SharedPitchState ) );
+}
+
+SharedMemoryOutput::~SharedMemoryOutput()
+{
+#if defined( _WIN32 )
+    if( mState )
+        UnmapViewOfFile( mState );
+    if( mHandle )
+        CloseHandle( mHandle );
+#else
+    if( mState ) {
+        munmap( mState, sizeof( SharedPitchState ) );
+        shm_unlink( mName.c_str() );
+    }
+#endif
+}
+
+void SharedMemoryOutput::send( const AnalysisFrame &frame )
+{
+    if( ! mState )
+        return;
+
+    // odd sequence while writing, readers retry until they see the same even value before and after
+    mState->mSequence = mState->mSequence + 1;
+    atomic_thread_fence( memory_order_release );
+
+    mState->mProcessedFrames = frame.mProcessedFrames;
+    mState->mSampleRate = frame.mSampleRate;
+    mState->mPitchFreq = frame.mPitchFreq;
+    mState->mPitchLevel = frame.mPitchLevel;
+    mState->mSpectralCentroid = frame.mSpectralCentroid;
+    mState->mInputLevel = frame.mInputLevel;
+
+    atomic_thread_fence( memory_order_release );
+    mState->mSequence = mState->mSequence + 1;
+}
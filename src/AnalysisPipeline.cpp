@@ -0,0 +1,392 @@
+#include "AnalysisPipeline.h"
+
+#include "cinder/audio/Context.h"
+#include "cinder/audio/Utilities.h"
+#include "cinder/Log.h"
+
+#include <algorithm>
+
+using namespace ci;
+using namespace std;
+
+AnalysisPipeline::AnalysisPipeline()
+    : mInputRevision( 0 ), mDevicesChanged( false ), mConfig( make_shared<AnalysisConfig>() ), mAnalyzer( make_shared<SpectralAnalyzer>( mConfig->mAnalysis ) ), mFormatQueued( false ), mFadeStartFrame( 0 ), mAudioThreadRestarted( false ), mRatesDirty( true ), mFrame( make_shared<AnalysisFrame>() ), mLastProcessedFrames( 0 )
+{
+}
+
+AnalysisPipeline::~AnalysisPipeline()
+{
+    // both workers use the graph and members
+    if( mInputRebuild.valid() )
+        mInputRebuild.wait();
+    if( mPreparing.valid() )
+        mPreparing.wait();
+}
+
+void AnalysisPipeline::setup()
+{
+    auto ctx = audio::Context::master();
+    // The InputDeviceNode is platform-specific, so you create it using a special method on the Context:
+    mInputDeviceNode = ctx->createInputDeviceNode( findInputDevice( mConfig->mInputDevice, mConfig->mBackupInputDevice ) );
+    // The monitor only buffers the most recent samples. The spectral analysis runs on them in update(), so its
+    // resolution can change without rebuilding the graph - see reconfigure().
+    mMonitorNode = ctx->makeNode( new audio::MonitorNode( audio::MonitorNode::Format().windowSize( kMaxWindowSize ) ) );
+    // Measures the audio callbacks in passing, for the block size auto-tuning (see BufferAutoTuner).
+    mTimingNode = ctx->makeNode( new CallbackTimingNode( audio::Node::Format().autoEnable() ) );
+    // Raw samples for the time-domain estimators, read in place instead of copied out of another monitor.
+    mRawSampleTap = ctx->makeNode( new RawSampleTap( audio::Node::Format().autoEnable(), kRawTapCapacity ) );
+    mRawReader = mRawSampleTap->createReader();
+    mInputDeviceNode >> mTimingNode >> mRawSampleTap >> mMonitorNode;
+
+    // The context runs at the output device's rate (input is converted to it), either device changing format
+    // can change it. Tables are only flagged here and rebuilt on the next update().
+    auto paramsDidChange = [this] { deviceParamsDidChange(); };
+    mInputParamsConnection = mInputDeviceNode->getDevice()->getSignalParamsDidChange().connect( paramsDidChange );
+    auto outputDeviceNode = dynamic_pointer_cast<audio::OutputDeviceNode>( ctx->getOutput() );
+    if( outputDeviceNode )
+        mOutputParamsConnection = outputDeviceNode->getDevice()->getSignalParamsDidChange().connect( paramsDidChange );
+    // Devices coming and going (a USB interface unplugged) only flag a check, see update()
+    mDevicesChangedConnection = audio::Context::deviceManager()->getSignalDevicesChanged().connect( [this] { mDevicesChanged = true; } );
+
+    // InputDeviceNode (and all InputNode subclasses) need to be enabled()'s to process audio. So does the Context:
+    mInputDeviceNode->enable();
+    ctx->enable();
+}
+
+void AnalysisPipeline::reconfigure( SpectralAnalyzer::Format format )
+{
+    format.mWindowSize = min( format.mWindowSize ? format.mWindowSize : format.mFftSize, kMaxWindowSize );
+
+    // FFT plan and tables are built off the calling thread. While one is still being prepared the latest request
+    // waits for it in update(), replacing the future now would block this thread until it is done.
+    if( mPreparing.valid() && mPreparing.wait_for( chrono::seconds( 0 ) ) != future_status::ready ) {
+        mQueuedFormat = format;
+        mFormatQueued = true;
+        return;
+    }
+
+    mFormatQueued = false;
+    ThreadPolicy policy = mConfig->mAnalysisThread;
+    mPreparing = async( launch::async, [this, format, policy] {
+        if( ! policy.isDefault() )
+            applyThreadPolicy( policy );
+        atomic_store( &mPendingAnalyzer, make_shared<SpectralAnalyzer>( format ) );
+    } );
+}
+
+void AnalysisPipeline::setConfig( const AnalysisConfigRef &config )
+{
+    if( ! config || config == mConfig )
+        return;
+
+    SpectralAnalyzer::Format current = mConfig->mAnalysis;
+    const SpectralAnalyzer::Format &next = config->mAnalysis;
+    bool inputChanged = config->mInputDevice != mConfig->mInputDevice || config->mBackupInputDevice != mConfig->mBackupInputDevice;
+    mConfig = config;
+    mRatesDirty = true;
+    if( inputChanged )
+        mDevicesChanged = true;
+
+    if( next.mFftSize != current.mFftSize || next.mWindowSize != current.mWindowSize || next.mWindowType != current.mWindowType
+        || next.mSmoothingFactor != current.mSmoothingFactor )
+        reconfigure( next );
+}
+
+bool AnalysisPipeline::update()
+{
+    if( mFormatQueued )
+        reconfigure( mQueuedFormat );
+
+    // Before the check for new samples: a device that was unplugged may have been the one driving the context, then
+    // nothing is processed until the devices are rebuilt. Devices are enumerated and opened on a worker, nothing after
+    // the input (monitor, analyzers, their smoothing) is touched, so the analysis stays warm across the switch. While
+    // the worker runs it owns the context: it creates the new input node, disconnects the old one and connects and
+    // enables the new one. Nothing else may touch the context or the input then (see isRebuilding()), this returns
+    // early and a replacement output is swapped in here once the worker is done. A change arriving during a rebuild
+    // is handled after it.
+    if( mInputRebuild.valid() ) {
+        if( mInputRebuild.wait_for( chrono::seconds( 0 ) ) != future_status::ready )
+            return false;
+
+        mInputRebuild.get();
+        if( mPendingOutput ) {
+            swapOutput( mPendingOutput );
+            mPendingOutput.reset();
+        }
+    }
+
+    if( mTimingNode && mDevicesChanged.exchange( false ) ) {
+        auto currentOutput = dynamic_pointer_cast<audio::OutputDeviceNode>( audio::master()->getOutput() );
+        audio::DeviceRef outputDevice = currentOutput ? currentOutput->getDevice() : nullptr;
+        string preferred = mConfig->mInputDevice, backup = mConfig->mBackupInputDevice;
+        mInputRebuild = async( launch::async, [this, outputDevice, preferred, backup] { rebuildDevices( outputDevice, preferred, backup ); } );
+        return false;
+    }
+
+    // The analysis only has a new frame once the audio thread has processed more samples.
+    uint64_t processedFrames = audio::master()->getNumProcessedFrames();
+    if( processedFrames == mLastProcessedFrames && ! mFrame->mMagSpectrum.empty() )
+        return false;
+
+    mLastProcessedFrames = processedFrames;
+
+    // A format change or a new output restarts the IO thread, which comes up without the policy: request it again.
+    if( mAudioThreadRestarted.exchange( false ) )
+        mAudioThreadPolicy = ThreadPolicy();
+
+    // retried every frame until the audio thread picked up the previous request
+    if( mConfig->mAudioThread != mAudioThreadPolicy && mTimingNode->requestThreadPolicy( mConfig->mAudioThread ) )
+        mAudioThreadPolicy = mConfig->mAudioThread;
+
+    ThreadPolicyResult audioThreadResult;
+    if( mTimingNode->takeThreadPolicyResult( &audioThreadResult ) ) {
+        if( audioThreadResult.isDenied() )
+            CI_LOG_W( "audio thread: " << audioThreadResult.describe() );
+        else
+            CI_LOG_I( "audio thread: " << audioThreadResult.describe() );
+    }
+
+    // swapping at a frame boundary, every frame is analyzed start to end by one analyzer
+    SpectralAnalyzerRef pending = atomic_exchange( &mPendingAnalyzer, SpectralAnalyzerRef() );
+    if( pending ) {
+        mFadingAnalyzer = mAnalyzer;
+        mAnalyzer = pending;
+        mFadeStartFrame = processedFrames;
+        mRatesDirty = true;
+    }
+
+    if( mRatesDirty.exchange( false ) )
+        updateRateTables();
+
+    // Reuse the previous spare frame once no consumer holds it anymore, so steady state publishing doesn't allocate.
+    shared_ptr<AnalysisFrame> frame = mSpareFrame.use_count() == 1 ? mSpareFrame : make_shared<AnalysisFrame>();
+    frame->mProcessedFrames = processedFrames;
+    analyze( frame.get() );
+
+    mSpareFrame = const_pointer_cast<AnalysisFrame>( mFrame );
+    mFrame = frame;
+    return true;
+}
+
+void AnalysisPipeline::deviceParamsDidChange()
+{
+    mRatesDirty = true;
+    mAudioThreadRestarted = true;
+}
+
+audio::DeviceRef AnalysisPipeline::findInputDevice( const string &preferred, const string &backup )
+{
+    for( const string &name : { preferred, backup } ) {
+        if( name.empty() )
+            continue;
+
+        for( const auto &device : audio::Device::getInputDevices() ) {
+            if( device->getName() == name )
+                return device;
+        }
+    }
+
+    return audio::Device::getDefaultInput();
+}
+
+void AnalysisPipeline::rebuildDevices( const audio::DeviceRef &outputDevice, const string &preferred, const string &backup )
+{
+    mPendingOutput = createOutput( outputDevice );
+    rebuildInput( preferred, backup );
+}
+
+audio::OutputDeviceNodeRef AnalysisPipeline::createOutput( const audio::DeviceRef &current )
+{
+    if( ! current )
+        return nullptr;
+
+    const auto &outputDevices = audio::Device::getOutputDevices();
+    if( find( outputDevices.begin(), outputDevices.end(), current ) != outputDevices.end() )
+        return nullptr;
+
+    audio::DeviceRef device = audio::Device::getDefaultOutput();
+    if( ! device ) {
+        CI_LOG_E( "no output device available, the context is stopped" );
+        return nullptr;
+    }
+
+    try {
+        return audio::master()->createOutputDeviceNode( device );
+    }
+    catch( std::exception &exc ) {
+        CI_LOG_E( "could not open " << device->getName() << ": " << exc.what() );
+        return nullptr;
+    }
+}
+
+void AnalysisPipeline::swapOutput( const audio::OutputDeviceNodeRef &node )
+{
+    // the auto-pulled monitor belongs to the context and moves over with it
+    auto ctx = audio::master();
+    bool enabled = ctx->isEnabled();
+    ctx->disable();
+    ctx->setOutput( node );
+    if( enabled )
+        ctx->enable();
+
+    mOutputParamsConnection = node->getDevice()->getSignalParamsDidChange().connect( [this] { deviceParamsDidChange(); } );
+    // a new output comes with a new IO thread
+    deviceParamsDidChange();
+    CI_LOG_I( "output switched to " << node->getDevice()->getName() );
+}
+
+void AnalysisPipeline::rebuildInput( const string &preferred, const string &backup )
+{
+    audio::InputDeviceNodeRef current = getInputDeviceNode();
+    audio::DeviceRef device = findInputDevice( preferred, backup );
+    if( ! device ) {
+        CI_LOG_E( "no input device available" );
+        return;
+    }
+
+    // nothing to do if the chosen device is the one in use and it is still there
+    const auto &inputDevices = audio::Device::getInputDevices();
+    bool currentPresent = current && find( inputDevices.begin(), inputDevices.end(), current->getDevice() ) != inputDevices.end();
+    if( currentPresent && current->getDevice() == device )
+        return;
+
+    try {
+        auto ctx = audio::master();
+        audio::InputDeviceNodeRef node = ctx->createInputDeviceNode( device );
+        if( current ) {
+            current->disable();
+            current->disconnectAll();
+        }
+
+        node >> mTimingNode;
+        node->enable();
+
+        mInputParamsConnection = device->getSignalParamsDidChange().connect( [this] { deviceParamsDidChange(); } );
+        atomic_store( &mInputDeviceNode, node );
+        mInputRevision++;
+        mRatesDirty = true;
+        CI_LOG_I( "input switched to " << device->getName() );
+    }
+    catch( std::exception &exc ) {
+        // leaves the old node in place, the next device change tries again
+        CI_LOG_E( "could not open " << device->getName() << ": " << exc.what() );
+    }
+}
+
+void AnalysisPipeline::updateRateTables()
+{
+    // the only place the analysis reads the device's sample rate, everything after the resampler runs at the analysis rate
+    float deviceRate = (float)audio::master()->getSampleRate();
+    float sampleRate = mConfig->mAnalysisRate > 0 ? mConfig->mAnalysisRate : deviceRate;
+    mResampler.setRates( deviceRate, sampleRate );
+
+    // the monitor holds the largest window at the analysis rate, which takes more device frames when converting down
+    size_t monitorSize = max( kMaxWindowSize, mResampler.getNumSourceFrames( kMaxWindowSize ) );
+    if( monitorSize != mMonitorNode->getWindowSize() )
+        resizeMonitor( monitorSize );
+
+    mRateTables = make_shared<RateTables>( sampleRate, deviceRate, mAnalyzer->getFftSize(), *mConfig );
+    size_t numRawFrames = mResampler.getNumSourceFrames( mRateTables->mMaxLag * 2 + mRateTables->mMaxLag / 2 );
+    if( numRawFrames > mRawSampleTap->getMaxWindowSize() )
+        CI_LOG_W( "the pitch cascade needs " << numRawFrames << " raw frames at " << deviceRate << " hertz, the tap holds "
+                    << mRawSampleTap->getMaxWindowSize() << ", the cascade is skipped" );
+    mFadingRateTables = mFadingAnalyzer ? make_shared<RateTables>( sampleRate, deviceRate, mFadingAnalyzer->getFftSize(), *mConfig ) : nullptr;
+}
+
+void AnalysisPipeline::resizeMonitor( size_t windowSize )
+{
+    // starts out silent, the first window after a rate change is partly zeros
+    auto monitorNode = audio::master()->makeNode( new audio::MonitorNode( audio::MonitorNode::Format().windowSize( windowSize ) ) );
+    mRawSampleTap->disconnectAllOutputs();
+    mRawSampleTap >> monitorNode;
+    mMonitorNode = monitorNode;
+}
+
+void AnalysisPipeline::analyze( AnalysisFrame *frame )
+{
+    frame->mSampleRate = mRateTables->mSampleRate;
+    const audio::Buffer *input = &mMonitorNode->getBuffer();
+
+    // With a fixed analysis rate, the end of the monitor's window is mixed down and converted first, the analyzers see
+    // only that. The monitor holds enough for the largest window, only the windows in use are converted.
+    if( ! mResampler.isBypassed() ) {
+        size_t windowSize = max( mAnalyzer->getWindowSize(), mFadingAnalyzer ? mFadingAnalyzer->getWindowSize() : 0 );
+        size_t numOutputFrames = min( mResampler.getNumOutputFrames( input->getNumFrames() ), windowSize );
+        const size_t numFrames = min( mResampler.getNumSourceFrames( numOutputFrames ), input->getNumFrames() );
+        const size_t offset = input->getNumFrames() - numFrames;
+
+        mMonoBuffer.assign( numFrames, 0.0f );
+        for( size_t ch = 0; ch < input->getNumChannels(); ch++ )
+            audio::dsp::add( mMonoBuffer.data(), input->getChannel( ch ) + offset, mMonoBuffer.data(), numFrames );
+        if( input->getNumChannels() > 1 )
+            audio::dsp::mul( mMonoBuffer.data(), 1.0f / (float)input->getNumChannels(), mMonoBuffer.data(), numFrames );
+
+        if( mResampledBuffer.getNumFrames() != numOutputFrames )
+            mResampledBuffer.setSize( numOutputFrames, 1 );
+
+        mResampler.processTail( mMonoBuffer.data(), numFrames, mResampledBuffer.getData(), numOutputFrames );
+        input = &mResampledBuffer;
+    }
+
+    const audio::Buffer &buffer = *input;
+
+    // We copy the magnitude spectrum out on the main thread, once per new frame:
+    mAnalyzer->process( buffer );
+    frame->mMagSpectrum = mAnalyzer->getMagSpectrum();
+
+    SpectralFeatures features = SpectralFeatures::measure( *mAnalyzer, *mRateTables, *mConfig );
+
+    // after a reconfigure(), blend from the previous analyzer's readings over one window of the new one
+    if( mFadingAnalyzer ) {
+        // processed frames count at the device rate, the window at the analysis rate
+        float elapsed = (float)( frame->mProcessedFrames - mFadeStartFrame ) * mResampler.getTargetRate() / mResampler.getSourceRate();
+        float fade = elapsed / (float)mAnalyzer->getWindowSize();
+        if( fade >= 1 ) {
+            mFadingAnalyzer.reset();
+            mFadingRateTables.reset();
+        }
+        else {
+            mFadingAnalyzer->process( buffer );
+            SpectralFeatures previous = SpectralFeatures::measure( *mFadingAnalyzer, *mFadingRateTables, *mConfig );
+            auto mix = [fade]( float a, float b ) { return a + ( b - a ) * fade; };
+
+            features.mSpectralCentroid = mix( previous.mSpectralCentroid, features.mSpectralCentroid );
+            features.mInputLevel = mix( previous.mInputLevel, features.mInputLevel );
+            features.mPitchFreq = mix( previous.mPitchFreq, features.mPitchFreq );
+            features.mPitchLevel = mix( previous.mPitchLevel, features.mPitchLevel );
+            // the published spectrum is the new analyzer's, so the bin follows the blended frequency
+            features.mPitchBin = min( mRateTables->getBinForFreq( features.mPitchFreq ), (float)frame->getNumBins() - 1 );
+        }
+    }
+
+    // the cascade over the latest raw window (long enough for two periods of the lowest pitch) and this frame's spectrum.
+    // With a fixed analysis rate the raw window is converted like the monitor's, so its readings don't depend on the device.
+    const RateTables &tables = *mRateTables;
+    const size_t rawWindow = tables.mMaxLag * 2 + tables.mMaxLag / 2;
+    const size_t numSourceFrames = mResampler.getNumSourceFrames( rawWindow );
+    const float *samples = mRawReader.latest( numSourceFrames );
+    if( samples && ! mResampler.isBypassed() ) {
+        mResampledRaw.resize( rawWindow );
+        mResampler.processTail( samples, numSourceFrames, mResampledRaw.data(), rawWindow );
+        samples = mResampledRaw.data();
+    }
+
+    PitchEngine::Result estimate;
+    if( samples ) {
+        estimate = mPitchEngine.process( samples, rawWindow, tables.mSampleRate, tables.mMinLag, tables.mMaxLag,
+                                         frame->mMagSpectrum.data(), frame->mMagSpectrum.size(), tables.mBinWidth,
+                                         mAnalyzer->getWindowSize(), mAnalyzer->getFft() );
+        if( ! mRawReader.isValid() )
+            estimate = PitchEngine::Result();
+    }
+
+    frame->mEstimateFreq = estimate.mEstimate.mFreq;
+    frame->mEstimateConfidence = estimate.mEstimate.mConfidence;
+    frame->mEstimateStage = (int)estimate.mStage;
+
+    frame->mSpectralCentroid = features.mSpectralCentroid;
+    frame->mInputLevel = features.mInputLevel;
+    frame->mPitchBin = features.mPitchBin;
+    frame->mPitchFreq = features.mPitchFreq;
+    frame->mPitchLevel = features.mPitchLevel;
+}
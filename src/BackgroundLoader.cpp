@@ -0,0 +1,57 @@
+#include "BackgroundLoader.h"
+
+#include "cinder/gl/gl.h"
+#include "cinder/Thread.h"
+
+using namespace ci;
+using namespace std;
+
+BackgroundLoader::BackgroundLoader()
+    : mQuit( false )
+{
+    // must be created on the thread whose context we share with
+    mContext = gl::Context::create( gl::context() );
+    mThread = thread( &BackgroundLoader::run, this );
+}
+
+BackgroundLoader::~BackgroundLoader()
+{
+    {
+        lock_guard<mutex> lock( mMutex );
+        mQuit = true;
+    }
+    mCondition.notify_one();
+    mThread.join();
+}
+
+void BackgroundLoader::push( function<void()> job )
+{
+    {
+        lock_guard<mutex> lock( mMutex );
+        mJobs.push_back( move( job ) );
+    }
+    mCondition.notify_one();
+}
+
+void BackgroundLoader::run()
+{
+    ThreadSetup threadSetup;
+    mContext->makeCurrent();
+
+    while( true ) {
+        function<void()> job;
+        {
+            unique_lock<mutex> lock( mMutex );
+            mCondition.wait( lock, [this] { return mQuit || ! mJobs.empty(); } );
+            if( mQuit )
+                return;
+
+            job = move( mJobs.front() );
+            mJobs.pop_front();
+        }
+
+        job();
+        // everything the job created has to be complete before another context uses it
+        glFinish();
+    }
+}
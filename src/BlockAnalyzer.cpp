@@ -0,0 +1,78 @@
+#include "BlockAnalyzer.h"
+
+#include "cinder/audio/dsp/Dsp.h"
+
+#include <algorithm>
+
+using namespace ci;
+using namespace std;
+
+BlockAnalyzer::BlockAnalyzer( float sampleRate, size_t hopSize, const AnalysisConfigRef &config )
+    : mSampleRate( sampleRate ), mHopSize( max<size_t>( 1, hopSize ) ), mRawWindow( 0 ), mCapacity( 0 ), mWritePosition( 0 ), mPendingFrames( 0 ),
+        mNumFrames( 0 ), mAnalyzedFrames( 0 )
+{
+    setConfig( config ? config : make_shared<AnalysisConfig>() );
+}
+
+void BlockAnalyzer::setConfig( const AnalysisConfigRef &config )
+{
+    // everything that can throw comes first, a failed call leaves the previous config working
+    auto analyzer = make_shared<SpectralAnalyzer>( config->mAnalysis );
+    auto tables = make_shared<RateTables>( mSampleRate, mSampleRate, analyzer->getFftSize(), *config );
+    size_t rawWindow = tables->mMaxLag * 2 + tables->mMaxLag / 2;
+    mPitchEngine.reserve( tables->mMaxLag, analyzer->getNumBins() );
+
+    // keeps what was already received if the history's size doesn't change
+    size_t capacity = audio::dsp::nextPowerOf2( max( analyzer->getWindowSize(), rawWindow ) );
+    if( capacity != mCapacity ) {
+        vector<float> history( capacity * 2, 0.0f );
+        mHistory.swap( history );
+        mCapacity = capacity;
+        mWritePosition = 0;
+    }
+
+    mConfig = config;
+    mAnalyzer = analyzer;
+    mRateTables = tables;
+    mRawWindow = rawWindow;
+}
+
+bool BlockAnalyzer::process( const float *samples, size_t numFrames )
+{
+    // only the most recent frames fit in the history
+    const size_t numSkipped = numFrames > mCapacity ? numFrames - mCapacity : 0;
+    const size_t mask = mCapacity - 1;
+    for( size_t i = numSkipped; i < numFrames; i++ ) {
+        size_t index = ( mWritePosition + i ) & mask;
+        mHistory[index] = samples[i];
+        mHistory[index + mCapacity] = samples[i];
+    }
+
+    mWritePosition = ( mWritePosition + numFrames ) & mask;
+    mNumFrames += numFrames;
+    mPendingFrames += numFrames;
+    if( mPendingFrames < mHopSize )
+        return false;
+
+    mPendingFrames %= mHopSize;
+    analyze();
+    return true;
+}
+
+void BlockAnalyzer::analyze()
+{
+    mAnalyzedFrames = mNumFrames;
+    const size_t windowSize = mAnalyzer->getWindowSize();
+    const float *window = &mHistory[( mWritePosition + mCapacity - windowSize ) & ( mCapacity - 1 )];
+
+    mAnalyzer->process( window, windowSize );
+    mFeatures = SpectralFeatures::measure( *mAnalyzer, *mRateTables, *mConfig );
+
+    const RateTables &tables = *mRateTables;
+    const float *raw = &mHistory[( mWritePosition + mCapacity - mRawWindow ) & ( mCapacity - 1 )];
+    const vector<float> &magSpectrum = mAnalyzer->getMagSpectrum();
+    mEstimate = mPitchEngine.process( raw, mRawWindow, tables.mSampleRate, tables.mMinLag, tables.mMaxLag,
+                                      magSpectrum.data(), magSpectrum.size(), tables.mBinWidth, windowSize, mAnalyzer->getFft() );
+
+    mNote = mEstimate.mEstimate.isVoiced() ? NoteReading( mEstimate.mEstimate.mFreq, mConfig->mTunerReference ) : NoteReading();
+}
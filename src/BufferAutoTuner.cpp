@@ -0,0 +1,212 @@
+#include "BufferAutoTuner.h"
+
+#include "cinder/audio/Context.h"
+#include "cinder/audio/Device.h"
+#include "cinder/audio/OutputNode.h"
+#include "cinder/Json.h"
+#include "cinder/Log.h"
+#include "cinder/Utilities.h"
+
+using namespace ci;
+using namespace std;
+
+BufferAutoTuner::BufferAutoTuner( const Options &options )
+    : mOptions( options ), mCandidateIndex( 0 ), mResult( 0 ), mProbing( false ), mForce( false ), mPhase( Phase::SETTLING ), mPhaseStart( -1 ),
+        mLastOverrun( 0 ), mLastUnderrun( 0 )
+{
+}
+
+void BufferAutoTuner::start( const audio::InputDeviceNodeRef &input, const CallbackTimingNodeRef &timing, bool force )
+{
+    mInput = input;
+    mTiming = timing;
+    mProbing = false;
+    mForce = force;
+
+    const string &deviceName = mInput->getDevice()->getName();
+    size_t current = mInput->getDevice()->getFramesPerBlock();
+    mResult = current;
+
+    size_t stored = force ? 0 : loadStored( deviceName );
+    if( stored ) {
+        CI_LOG_I( "using stored block size " << stored << " for " << deviceName );
+        apply( stored );
+        mResult = stored;
+        return;
+    }
+
+    // the current (platform default) size is known to work, try halving it from there
+    mCandidates.clear();
+    for( size_t size = current / 2; size >= mOptions.mMinFramesPerBlock; size /= 2 )
+        mCandidates.push_back( size );
+
+    if( mCandidates.empty() )
+        return;
+
+    CI_LOG_I( "probing block sizes below " << current << " for " << deviceName );
+    mProbing = true;
+    mCandidateIndex = 0;
+    apply( mCandidates[0] );
+    mPhase = Phase::SETTLING;
+    mPhaseStart = -1;
+}
+
+void BufferAutoTuner::setInput( const audio::InputDeviceNodeRef &input )
+{
+    if( mProbing ) {
+        start( input, mTiming, mForce );
+        return;
+    }
+
+    mInput = input;
+    mResult = mInput->getDevice()->getFramesPerBlock();
+
+    size_t stored = loadStored( mInput->getDevice()->getName() );
+    if( stored ) {
+        apply( stored );
+        mResult = stored;
+    }
+}
+
+void BufferAutoTuner::update( double time )
+{
+    if( ! mProbing )
+        return;
+
+    if( mPhaseStart < 0 )
+        mPhaseStart = time;
+
+    if( mPhase == Phase::SETTLING ) {
+        if( time - mPhaseStart < mOptions.mSettleSeconds )
+            return;
+
+        // xruns are reported as the frame they happened at, a change means a new one
+        mTiming->reset();
+        mLastOverrun = mInput->getLastOverrun();
+        mLastUnderrun = mInput->getLastUnderrun();
+        mPhase = Phase::MEASURING;
+        mPhaseStart = time;
+        return;
+    }
+
+    if( time - mPhaseStart < mOptions.mMeasureSeconds )
+        return;
+
+    size_t size = mCandidates[mCandidateIndex];
+    if( ! measure() ) {
+        finish();
+        return;
+    }
+
+    mResult = size;
+    if( ++mCandidateIndex == mCandidates.size() ) {
+        finish();
+        return;
+    }
+
+    apply( mCandidates[mCandidateIndex] );
+    mPhase = Phase::SETTLING;
+    mPhaseStart = time;
+}
+
+void BufferAutoTuner::suspend()
+{
+    if( ! mProbing )
+        return;
+
+    // the candidate was applied before the rebuild, it only needs to settle again
+    mPhase = Phase::SETTLING;
+    mPhaseStart = -1;
+}
+
+bool BufferAutoTuner::measure() const
+{
+    size_t size = mCandidates[mCandidateIndex];
+    double period = (double)size / (double)audio::master()->getSampleRate();
+    double expectedCallbacks = mOptions.mMeasureSeconds / period;
+    CallbackTimingNode::Stats stats = mTiming->getStats();
+
+    bool xrun = mInput->getLastOverrun() != mLastOverrun || mInput->getLastUnderrun() != mLastUnderrun;
+    bool jitter = stats.mMaxDeviation > period * mOptions.mMaxJitter;
+    bool missed = (double)stats.mNumCallbacks < expectedCallbacks * mOptions.mMinCallbackRatio;
+
+    CI_LOG_I( "block size " << size << ": " << stats.mNumCallbacks << " callbacks, max deviation " << stats.mMaxDeviation * 1000 << " ms"
+                << ( xrun ? ", xrun" : "" ) << ( jitter || missed || xrun ? " - unstable" : " - stable" ) );
+
+    return ! ( xrun || jitter || missed );
+}
+
+void BufferAutoTuner::finish()
+{
+    mProbing = false;
+    if( mInput->getDevice()->getFramesPerBlock() != mResult )
+        apply( mResult );
+
+    const string &deviceName = mInput->getDevice()->getName();
+    store( deviceName, mResult );
+    CI_LOG_I( "settled on block size " << mResult << " for " << deviceName );
+}
+
+void BufferAutoTuner::apply( size_t framesPerBlock )
+{
+    auto format = audio::Device::Format().framesPerBlock( framesPerBlock );
+    mInput->getDevice()->updateFormat( format );
+
+    // the context processes at the output device's block size, the input only gets as low as that
+    auto outputDeviceNode = dynamic_pointer_cast<audio::OutputDeviceNode>( audio::master()->getOutput() );
+    if( outputDeviceNode && outputDeviceNode->getDevice() != mInput->getDevice() )
+        outputDeviceNode->getDevice()->updateFormat( format );
+}
+
+fs::path BufferAutoTuner::getStorePath()
+{
+    return getHomeDirectory() / ".InputAnalyzer-buffers.json";
+}
+
+size_t BufferAutoTuner::loadStored( const string &deviceName )
+{
+    if( ! fs::exists( getStorePath() ) )
+        return 0;
+
+    try {
+        // an array of { device, framesPerBlock }, device names can contain the dots JsonTree uses as path separators
+        JsonTree json( loadFile( getStorePath() ) );
+        for( const auto &entry : json ) {
+            if( entry.getValueForKey<string>( "device" ) == deviceName )
+                return entry.getValueForKey<size_t>( "framesPerBlock" );
+        }
+    }
+    catch( std::exception &exc ) {
+        CI_LOG_W( "ignoring " << getStorePath() << ": " << exc.what() );
+    }
+
+    return 0;
+}
+
+void BufferAutoTuner::store( const string &deviceName, size_t framesPerBlock )
+{
+    JsonTree entries = JsonTree::makeArray();
+    try {
+        if( fs::exists( getStorePath() ) ) {
+            for( const auto &entry : JsonTree( loadFile( getStorePath() ) ) ) {
+                if( entry.getValueForKey<string>( "device" ) != deviceName )
+                    entries.pushBack( entry );
+            }
+        }
+    }
+    catch( std::exception & ) {
+        // rewritten below
+    }
+
+    JsonTree entry = JsonTree::makeObject();
+    entry.addChild( JsonTree( "device", deviceName ) );
+    entry.addChild( JsonTree( "framesPerBlock", (uint64_t)framesPerBlock ) );
+    entries.pushBack( entry );
+
+    try {
+        entries.write( getStorePath() );
+    }
+    catch( std::exception &exc ) {
+        CI_LOG_W( "could not store block size: " << exc.what() );
+    }
+}
@@ -0,0 +1,76 @@
+#include "CallbackTimingNode.h"
+
+using namespace ci;
+using namespace std;
+
+CallbackTimingNode::CallbackTimingNode( const Format &format )
+    : Node( format ), mHasLastCallback( false ), mResetRequested( false ), mNumIntervals( 0 ), mTotalNanoseconds( 0 ),
+        mMaxDeviationNanoseconds( 0 ), mPolicyRequest( 0 ), mPolicyApplied( 0 ), mPolicyReported( 0 )
+{
+}
+
+CallbackTimingNode::Stats CallbackTimingNode::getStats() const
+{
+    Stats stats;
+    uint64_t numIntervals = mNumIntervals;
+    stats.mNumCallbacks = numIntervals;
+    stats.mMaxDeviation = (double)mMaxDeviationNanoseconds * 1e-9;
+    stats.mMeanInterval = numIntervals ? (double)mTotalNanoseconds * 1e-9 / (double)numIntervals : 0;
+    return stats;
+}
+
+bool CallbackTimingNode::requestThreadPolicy( const ThreadPolicy &policy )
+{
+    uint32_t request = mPolicyRequest.load( memory_order_relaxed );
+    if( mPolicyApplied.load( memory_order_acquire ) != request )
+        return false;
+
+    mRequestedPolicy = policy;
+    mPolicyRequest.store( request + 1, memory_order_release );
+    return true;
+}
+
+bool CallbackTimingNode::takeThreadPolicyResult( ThreadPolicyResult *result )
+{
+    uint32_t applied = mPolicyApplied.load( memory_order_acquire );
+    if( applied == mPolicyReported )
+        return false;
+
+    *result = mPolicyResult;
+    mPolicyReported = applied;
+    return true;
+}
+
+void CallbackTimingNode::process( audio::Buffer *buffer )
+{
+    // the buffer passes through untouched
+    auto now = chrono::steady_clock::now();
+
+    // the audio thread is owned by the platform, this is the only place it can be configured from
+    uint32_t request = mPolicyRequest.load( memory_order_acquire );
+    if( request != mPolicyApplied.load( memory_order_relaxed ) ) {
+        mPolicyResult = applyAudioThreadPolicy( mRequestedPolicy );
+        mPolicyApplied.store( request, memory_order_release );
+    }
+
+    if( mResetRequested.exchange( false ) ) {
+        mNumIntervals = 0;
+        mTotalNanoseconds = 0;
+        mMaxDeviationNanoseconds = 0;
+        mHasLastCallback = false;
+    }
+
+    if( mHasLastCallback ) {
+        int64_t interval = chrono::duration_cast<chrono::nanoseconds>( now - mLastCallback ).count();
+        int64_t period = (int64_t)( (double)getFramesPerBlock() * 1e9 / (double)getSampleRate() );
+        uint64_t deviation = (uint64_t)( interval > period ? interval - period : period - interval );
+
+        mNumIntervals++;
+        mTotalNanoseconds += (uint64_t)interval;
+        if( deviation > mMaxDeviationNanoseconds )
+            mMaxDeviationNanoseconds = deviation;
+    }
+
+    mLastCallback = now;
+    mHasLastCallback = true;
+}
@@ -0,0 +1,92 @@
+#include "CepstralEstimator.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace ci;
+using namespace std;
+
+namespace {
+
+// calibrated on white noise: the ratio a pure noise peak reaches, relative to sqrt( 2 ln n ), about 3 at the default window
+const float kNoisePeakScale = 0.9f;
+
+} // anonymous namespace
+
+CepstralEstimator::CepstralEstimator()
+{
+}
+
+void CepstralEstimator::reserve( size_t fftSize )
+{
+    if( mCepstrum.getNumFrames() != fftSize ) {
+        mLogSpectrum = audio::BufferSpectral( fftSize );
+        mCepstrum = audio::Buffer( fftSize );
+    }
+}
+
+PitchEstimate CepstralEstimator::estimate( const float *magSpectrum, size_t numBins, size_t windowSize, float sampleRate, float minFreq, float maxFreq,
+                                           audio::dsp::Fft *fft )
+{
+    const size_t fftSize = numBins * 2;
+    if( ! magSpectrum || ! fft || fft->getSize() != fftSize || minFreq <= 0 || maxFreq <= minFreq )
+        return PitchEstimate();
+
+    // quefrencies (in frames) of the pitch range; the upper half of the cepstrum mirrors the lower
+    const size_t minQuefrency = max<size_t>( 2, (size_t)floor( sampleRate / maxFreq ) );
+    const size_t maxQuefrency = min( min( fftSize / 2, windowSize / 3 ) - 2, (size_t)ceil( sampleRate / minFreq ) );
+    if( windowSize < 12 || maxQuefrency <= minQuefrency + 2 )
+        return PitchEstimate();
+
+    reserve( fftSize );
+
+    // floored 80 dB below the peak, so empty bins don't dominate the log spectrum
+    const float peakMag = *max_element( magSpectrum, magSpectrum + numBins );
+    if( peakMag <= 0 )
+        return PitchEstimate();
+
+    const float floorMag = peakMag * 1e-4f;
+    float *real = mLogSpectrum.getReal();
+    float *imag = mLogSpectrum.getImag();
+    for( size_t i = 0; i < numBins; i++ ) {
+        real[i] = log( max( magSpectrum[i], floorMag ) );
+        imag[i] = 0;
+    }
+
+    // the packed nyquist component isn't part of the magnitude spectrum, repeat the last bin
+    imag[0] = real[numBins - 1];
+
+    fft->inverse( &mLogSpectrum, &mCepstrum );
+    const float *cepstrum = mCepstrum.getData();
+
+    // the spectral envelope and the window's shape leave a lobe at the lowest quefrencies, start past its slope
+    size_t start = minQuefrency;
+    while( start < maxQuefrency && cepstrum[start + 1] < cepstrum[start] )
+        start++;
+
+    size_t peak = start;
+    float sumSquares = 0;
+    for( size_t q = start; q <= maxQuefrency; q++ ) {
+        sumSquares += cepstrum[q] * cepstrum[q];
+        if( cepstrum[q] > cepstrum[peak] )
+            peak = q;
+    }
+
+    if( cepstrum[peak] <= 0 || peak == start || peak == maxQuefrency )
+        return PitchEstimate();
+
+    // parabolic interpolation between the neighbouring quefrencies
+    float refined = (float)peak;
+    float prev = cepstrum[peak - 1], current = cepstrum[peak], next = cepstrum[peak + 1];
+    float denominator = prev - 2 * current + next;
+    if( denominator < 0 )
+        refined += 0.5f * ( prev - next ) / denominator;
+
+    // the highest of n noise values grows like sqrt( 2 ln n ) times their RMS, so longer searches (larger windows) need
+    // a taller peak for the same confidence
+    const float numSearched = (float)( maxQuefrency - start + 1 );
+    float rms = sqrt( sumSquares / numSearched );
+    float noisePeak = kNoisePeakScale * sqrt( 2 * log( numSearched ) );
+    float confidence = max( 0.0f, 1 - noisePeak * rms / current );
+    return PitchEstimate( sampleRate / refined, confidence );
+}
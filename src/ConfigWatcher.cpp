@@ -0,0 +1,96 @@
+#include "ConfigWatcher.h"
+
+#include "cinder/Log.h"
+#include "cinder/Thread.h"
+
+#include <fstream>
+#include <sstream>
+
+using namespace ci;
+using namespace std;
+
+ConfigWatcher::ConfigWatcher()
+    : mConfig( make_shared<AnalysisConfig>() ), mRunning( false )
+{
+}
+
+ConfigWatcher::~ConfigWatcher()
+{
+    stop();
+}
+
+void ConfigWatcher::start( const fs::path &path, double pollSeconds )
+{
+    stop();
+
+    mPath = path;
+    mContents.clear();
+
+    // give the user a complete file to edit
+    if( ! fs::exists( mPath ) ) {
+        ofstream file( mPath.string() );
+        file << getConfig()->toJson().serialize();
+        if( ! file )
+            CI_LOG_W( "could not write default config to " << mPath );
+    }
+
+    // the first load happens here, so the initial config is in place before start() returns
+    load();
+
+    mRunning = true;
+    mThread = thread( &ConfigWatcher::run, this, pollSeconds );
+}
+
+void ConfigWatcher::stop()
+{
+    {
+        lock_guard<mutex> lock( mMutex );
+        if( ! mRunning )
+            return;
+
+        mRunning = false;
+    }
+
+    mCondition.notify_one();
+    mThread.join();
+}
+
+void ConfigWatcher::run( double pollSeconds )
+{
+    ThreadSetup threadSetup;
+    auto interval = chrono::microseconds( (long long)( pollSeconds * 1e6 ) );
+
+    unique_lock<mutex> lock( mMutex );
+    while( ! mCondition.wait_for( lock, interval, [this] { return ! mRunning; } ) ) {
+        lock.unlock();
+        if( load() )
+            CI_LOG_I( "reloaded " << mPath );
+        lock.lock();
+    }
+}
+
+bool ConfigWatcher::load()
+{
+    // comparing contents rather than modification times also catches editors that replace the file
+    ifstream file( mPath.string() );
+    if( ! file )
+        return false;
+
+    stringstream contents;
+    contents << file.rdbuf();
+    if( contents.str() == mContents )
+        return false;
+
+    mContents = contents.str();
+
+    try {
+        AnalysisConfigRef config = AnalysisConfig::create( JsonTree( mContents ) );
+        atomic_store( &mConfig, config );
+        return true;
+    }
+    catch( std::exception &exc ) {
+        // a half-saved or mistyped file, keep the last good config until the next change
+        CI_LOG_E( "ignoring " << mPath << ": " << exc.what() );
+        return false;
+    }
+}
@@ -0,0 +1,515 @@
+#include "ContourIndex.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+
+#if defined( _WIN32 )
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+using namespace ci;
+using namespace std;
+
+const size_t    ContourIndex::kGramLength;
+const int       ContourIndex::kMaxInterval;
+const uint32_t  ContourIndex::kVersion;
+const size_t    ContourIndex::kNumSymbols;
+const size_t    ContourIndex::kNumGrams;
+
+namespace {
+
+const char kMagic[4] = { 'I', 'A', 'C', 'I' };
+
+// hits within this many intervals of an alignment support it, a query often gains or loses a note
+const int kAlignmentSlack = 1;
+
+struct Hit {
+    int         mAlignment;     // clip interval the query starts at
+    uint32_t    mPosition;      // query interval of the n-gram
+};
+
+struct Candidate {
+    uint32_t    mClip;
+    int         mAlignment;     // clip interval the query starts at
+    uint32_t    mSupport;       // query positions with a hit within kAlignmentSlack of it
+};
+
+size_t align8( size_t offset )
+{
+    return ( offset + 7 ) & ~(size_t)7;
+}
+
+struct Layout {
+    Layout( const ContourIndex::Header &header )
+    {
+        mGramStarts = align8( sizeof( ContourIndex::Header ) );
+        mPostings = align8( mGramStarts + ( ContourIndex::kNumGrams + 1 ) * sizeof( uint32_t ) );
+        mClips = align8( mPostings + (size_t)header.mNumPostings * sizeof( ContourIndex::Posting ) );
+        mIntervals = align8( mClips + (size_t)header.mNumClips * sizeof( ContourIndex::Clip ) );
+        mNames = align8( mIntervals + (size_t)header.mNumIntervals * sizeof( float ) );
+        mEnd = mNames + (size_t)header.mNamesSize;
+    }
+
+    size_t mGramStarts, mPostings, mClips, mIntervals, mNames, mEnd;
+};
+
+size_t getGram( const float *intervals )
+{
+    size_t gram = 0;
+    for( size_t i = 0; i < ContourIndex::kGramLength; i++ )
+        gram = gram * ContourIndex::kNumSymbols + ContourIndex::getSymbol( intervals[i] );
+
+    return gram;
+}
+
+//! The n-grams a sung query at \a intervals may stand for: the nearest semitones of each interval, and any other
+//! within \a tolerance.
+void getQueryGrams( const float *intervals, float tolerance, vector<uint32_t> *grams )
+{
+    grams->assign( 1, 0 );
+    for( size_t i = 0; i < ContourIndex::kGramLength; i++ ) {
+        // symbols of consecutive semitones are consecutive, those clamped to an octave collapse into one
+        float interval = intervals[i];
+        size_t nearest = ContourIndex::getSymbol( interval );
+        size_t lowest = min( nearest, ContourIndex::getSymbol( ceil( interval - tolerance ) ) );
+        size_t highest = max( nearest, ContourIndex::getSymbol( floor( interval + tolerance ) ) );
+
+        size_t numGrams = grams->size();
+        for( size_t g = 0; g < numGrams; g++ ) {
+            uint32_t prefix = (*grams)[g] * (uint32_t)ContourIndex::kNumSymbols;
+            (*grams)[g] = prefix + (uint32_t)lowest;
+            for( size_t symbol = lowest + 1; symbol <= highest; symbol++ )
+                grams->push_back( prefix + (uint32_t)symbol );
+        }
+    }
+}
+
+//! The notes of \a numIntervals intervals relative to their mean pitch, which makes them independent of the key.
+//! Matching notes rather than intervals turns a dropped or added note into a single step of the warping path.
+void getRelativePitches( const float *intervals, size_t numIntervals, vector<float> *pitches )
+{
+    pitches->resize( numIntervals + 1 );
+    float pitch = 0, sum = 0;
+    (*pitches)[0] = 0;
+    for( size_t i = 0; i < numIntervals; i++ ) {
+        pitch += intervals[i];
+        (*pitches)[i + 1] = pitch;
+        sum += pitch;
+    }
+
+    const float mean = sum / (float)( numIntervals + 1 );
+    for( float &p : *pitches )
+        p -= mean;
+}
+
+//! Sum of squared differences along the best warping path within \a band of the diagonal, widened by the length
+//! difference. Gives up and returns infinity as soon as every path costs more than \a abandonAbove.
+float getDtwCost( const float *query, size_t queryLength, const float *clip, size_t clipLength, size_t band, float abandonAbove )
+{
+    const float inf = numeric_limits<float>::infinity();
+    const size_t radius = band + ( queryLength > clipLength ? queryLength - clipLength : clipLength - queryLength );
+
+    vector<float> previous( clipLength + 1, inf ), current( clipLength + 1, inf );
+    previous[0] = 0;
+    for( size_t i = 1; i <= queryLength; i++ ) {
+        fill( current.begin(), current.end(), inf );
+        size_t first = i > radius ? i - radius : 1;
+        size_t last = min( clipLength, i + radius );
+        float rowMin = inf;
+        for( size_t j = first; j <= last; j++ ) {
+            float diff = query[i - 1] - clip[j - 1];
+            float cost = diff * diff + min( previous[j - 1], min( previous[j], current[j - 1] ) );
+            current[j] = cost;
+            rowMin = min( rowMin, cost );
+        }
+
+        if( rowMin > abandonAbove )
+            return inf;
+
+        previous.swap( current );
+    }
+
+    return previous[clipLength];
+}
+
+//! LB_Keogh of \a clip against the query's envelope: a lower bound of the banded DTW cost, for equal lengths.
+float getLowerBound( const float *clip, const vector<float> &upper, const vector<float> &lower, float abandonAbove )
+{
+    float bound = 0;
+    for( size_t i = 0; i < upper.size() && bound <= abandonAbove; i++ ) {
+        float excess = clip[i] > upper[i] ? clip[i] - upper[i] : clip[i] < lower[i] ? lower[i] - clip[i] : 0.0f;
+        bound += excess * excess;
+    }
+
+    return bound;
+}
+
+void unmap( const uint8_t *data, size_t size, void *handle )
+{
+#if defined( _WIN32 )
+    if( data )
+        UnmapViewOfFile( data );
+    if( handle )
+        CloseHandle( handle );
+#else
+    (void)handle;
+    if( data )
+        munmap( const_cast<uint8_t *>( data ), size );
+#endif
+}
+
+} // anonymous namespace
+
+// ----------------------------------------------------------------------------------------------------
+// ContourIndex
+// ----------------------------------------------------------------------------------------------------
+
+size_t ContourIndex::getSymbol( float interval )
+{
+    int semitones = (int)floor( max( -(float)kMaxInterval, min( (float)kMaxInterval, interval ) ) + 0.5f );
+    return (size_t)( semitones + kMaxInterval );
+}
+
+ContourIndex::ContourIndex( const fs::path &path )
+    : mData( nullptr ), mSize( 0 ), mHandle( nullptr )
+{
+#if defined( _WIN32 )
+    HANDLE file = CreateFileW( path.wstring().c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr );
+    LARGE_INTEGER fileSize;
+    if( file == INVALID_HANDLE_VALUE || ! GetFileSizeEx( file, &fileSize ) ) {
+        if( file != INVALID_HANDLE_VALUE )
+            CloseHandle( file );
+        throw ContourIndexExc( "could not open " + path.string() );
+    }
+
+    // the mapping keeps the file open
+    mSize = (size_t)fileSize.QuadPart;
+    mHandle = mSize ? CreateFileMappingW( file, nullptr, PAGE_READONLY, 0, 0, nullptr ) : nullptr;
+    CloseHandle( file );
+    if( mHandle )
+        mData = static_cast<const uint8_t *>( MapViewOfFile( mHandle, FILE_MAP_READ, 0, 0, 0 ) );
+#else
+    int fd = open( path.c_str(), O_RDONLY );
+    struct stat status;
+    if( fd < 0 || fstat( fd, &status ) != 0 ) {
+        if( fd >= 0 )
+            close( fd );
+        throw ContourIndexExc( "could not open " + path.string() );
+    }
+
+    mSize = (size_t)status.st_size;
+    void *addr = mSize ? mmap( nullptr, mSize, PROT_READ, MAP_SHARED, fd, 0 ) : MAP_FAILED;
+    close( fd );
+    if( addr != MAP_FAILED )
+        mData = static_cast<const uint8_t *>( addr );
+#endif
+
+    if( ! mData ) {
+        unmap( mData, mSize, mHandle );
+        throw ContourIndexExc( "could not map " + path.string() );
+    }
+
+    // everything a query dereferences without checking is validated here; the postings are only bounds checked
+    // as they are read, validating them up front would page in the whole index
+    const char *error = nullptr;
+    mHeader = reinterpret_cast<const Header *>( mData );
+    if( mSize < sizeof( Header ) || memcmp( mHeader->mMagic, kMagic, sizeof( kMagic ) ) != 0 )
+        error = "not a contour index";
+    else if( mHeader->mVersion != kVersion || mHeader->mGramLength != kGramLength || mHeader->mMaxInterval != (uint32_t)kMaxInterval )
+        error = "index was written by an incompatible version";
+    else if( mHeader->mNumPostings > mSize || mHeader->mNumClips > mSize || mHeader->mNumIntervals > mSize || mHeader->mNamesSize > mSize
+             || Layout( *mHeader ).mEnd > mSize )
+        error = "index is truncated";
+
+    if( ! error ) {
+        Layout layout( *mHeader );
+        mGramStarts = reinterpret_cast<const uint32_t *>( mData + layout.mGramStarts );
+        mPostings = reinterpret_cast<const Posting *>( mData + layout.mPostings );
+        mClips = reinterpret_cast<const Clip *>( mData + layout.mClips );
+        mIntervals = reinterpret_cast<const float *>( mData + layout.mIntervals );
+        mNames = reinterpret_cast<const char *>( mData + layout.mNames );
+
+        for( size_t i = 0; i < kNumGrams && ! error; i++ ) {
+            if( mGramStarts[i] > mGramStarts[i + 1] )
+                error = "index has corrupt n-grams";
+        }
+        if( mGramStarts[kNumGrams] != mHeader->mNumPostings )
+            error = "index has corrupt n-grams";
+
+        for( size_t i = 0; i < mHeader->mNumClips && ! error; i++ ) {
+            const Clip &clip = mClips[i];
+            if( (uint64_t)clip.mIntervalOffset + clip.mNumIntervals > mHeader->mNumIntervals
+                || (uint64_t)clip.mNameOffset + clip.mNameLength > mHeader->mNamesSize )
+                error = "index has corrupt clips";
+        }
+    }
+
+    if( error ) {
+        unmap( mData, mSize, mHandle );
+        throw ContourIndexExc( string( error ) + ": " + path.string() );
+    }
+}
+
+ContourIndex::~ContourIndex()
+{
+    unmap( mData, mSize, mHandle );
+}
+
+string ContourIndex::getClipName( size_t clip ) const
+{
+    if( clip >= getNumClips() )
+        return string();
+
+    return string( mNames + mClips[clip].mNameOffset, mClips[clip].mNameLength );
+}
+
+vector<ContourIndex::Match> ContourIndex::query( const vector<float> &intervals, const QueryOptions &options ) const
+{
+    vector<Match> result;
+    const size_t numClips = getNumClips();
+    const size_t queryLength = intervals.size();
+    if( queryLength < kGramLength || ! numClips || ! options.mMaxResults )
+        return result;
+
+    const size_t numPositions = queryLength - kGramLength + 1;
+    vector<vector<uint32_t>> positionGrams( numPositions );
+    for( size_t p = 0; p < numPositions; p++ )
+        getQueryGrams( &intervals[p], max( 0.0f, options.mIntervalTolerance ), &positionGrams[p] );
+
+    // every hit of a query n-gram guesses where the query starts in a clip; a clip's alignment is the one the most
+    // query positions agree on, so clips that merely contain the n-grams somewhere don't outvote the sung one.
+    // The hits are bucketed by clip (a counting sort, there are far more hits than clips), then sorted by alignment.
+    vector<uint32_t> clipStarts( numClips + 1, 0 );
+    for( size_t p = 0; p < numPositions; p++ ) {
+        for( uint32_t gram : positionGrams[p] ) {
+            for( uint32_t i = mGramStarts[gram]; i < mGramStarts[gram + 1]; i++ ) {
+                if( mPostings[i].mClip < numClips )
+                    clipStarts[mPostings[i].mClip + 1]++;
+            }
+        }
+    }
+    for( size_t clip = 0; clip < numClips; clip++ )
+        clipStarts[clip + 1] += clipStarts[clip];
+
+    vector<Hit> hits( clipStarts[numClips] );
+    vector<uint32_t> next( clipStarts.begin(), clipStarts.end() - 1 );
+    for( size_t p = 0; p < numPositions; p++ ) {
+        for( uint32_t gram : positionGrams[p] ) {
+            for( uint32_t i = mGramStarts[gram]; i < mGramStarts[gram + 1]; i++ ) {
+                const Posting &posting = mPostings[i];
+                if( posting.mClip < numClips ) {
+                    Hit &hit = hits[next[posting.mClip]++];
+                    hit.mAlignment = (int)posting.mPosition - (int)p;
+                    hit.mPosition = (uint32_t)p;
+                }
+            }
+        }
+    }
+
+    // query positions within kAlignmentSlack of each alignment, counted once however many of their n-grams hit
+    vector<Candidate> candidates;
+    vector<uint32_t> positionHits( numPositions, 0 );
+    for( size_t clip = 0; clip < numClips; clip++ ) {
+        const size_t begin = clipStarts[clip], end = clipStarts[clip + 1];
+        if( begin == end )
+            continue;
+
+        sort( hits.begin() + begin, hits.begin() + end, []( const Hit &a, const Hit &b ) { return a.mAlignment < b.mAlignment; } );
+        Candidate candidate = { (uint32_t)clip, 0, 0 };
+        uint32_t support = 0;
+        size_t lo = begin, hi = begin;
+        for( size_t i = begin; i < end; i++ ) {
+            if( i > begin && hits[i].mAlignment == hits[i - 1].mAlignment )
+                continue;
+
+            for( ; hi < end && hits[hi].mAlignment <= hits[i].mAlignment + kAlignmentSlack; hi++ ) {
+                if( positionHits[hits[hi].mPosition]++ == 0 )
+                    support++;
+            }
+            for( ; hits[lo].mAlignment < hits[i].mAlignment - kAlignmentSlack; lo++ ) {
+                if( --positionHits[hits[lo].mPosition] == 0 )
+                    support--;
+            }
+
+            if( support > candidate.mSupport ) {
+                candidate.mSupport = support;
+                candidate.mAlignment = hits[i].mAlignment;
+            }
+        }
+
+        for( ; lo < hi; lo++ )
+            positionHits[hits[lo].mPosition]--;
+
+        candidates.push_back( candidate );
+    }
+
+    // the best supported go first, so the results fill early and LB_Keogh prunes more of the rest
+    const size_t numCandidates = min( candidates.size(), max( options.mMaxCandidates, options.mMaxResults ) );
+    partial_sort( candidates.begin(), candidates.begin() + numCandidates, candidates.end(), []( const Candidate &a, const Candidate &b ) {
+        return a.mSupport != b.mSupport ? a.mSupport > b.mSupport : a.mClip < b.mClip;
+    } );
+    candidates.resize( numCandidates );
+
+    // the query's notes and their envelope for LB_Keogh
+    vector<float> queryPitches, segmentPitches;
+    getRelativePitches( intervals.data(), queryLength, &queryPitches );
+
+    const size_t band = options.mBand;
+    const size_t numQueryNotes = queryPitches.size();
+    vector<float> upper( numQueryNotes ), lower( numQueryNotes );
+    for( size_t i = 0; i < numQueryNotes; i++ ) {
+        auto first = queryPitches.begin() + ( i > band ? i - band : 0 );
+        auto last = queryPitches.begin() + min( numQueryNotes, i + band + 1 );
+        upper[i] = *max_element( first, last );
+        lower[i] = *min_element( first, last );
+    }
+
+    for( const auto &candidate : candidates ) {
+        const uint32_t clip = candidate.mClip;
+        const int alignment = candidate.mAlignment;
+        const float *clipIntervals = mIntervals + mClips[clip].mIntervalOffset;
+        const size_t clipLength = mClips[clip].mNumIntervals;
+
+        // The query against the clip's notes at the alignment and next to it; clips shorter than the query are
+        // compared as a whole. The window is clamped into the clip, an alignment before its start (the query has notes
+        // ahead of it) or past the last full segment (the clip is shorter than the query) still gets compared.
+        const size_t segmentLength = min( clipLength, queryLength );
+        const int maxStart = (int)( clipLength - segmentLength );
+        const int firstStart = min( max( alignment - kAlignmentSlack, 0 ), maxStart );
+        const int lastStart = min( max( alignment + kAlignmentSlack, 0 ), maxStart );
+        const float scale = (float)( max( queryLength, segmentLength ) + 1 );
+        float bestCost = numeric_limits<float>::infinity();
+        size_t bestStart = 0;
+        for( int start = firstStart; start <= lastStart; start++ ) {
+
+            // a candidate has to beat the worst result kept, and its own best alignment so far
+            float abandonAbove = bestCost;
+            if( result.size() == options.mMaxResults )
+                abandonAbove = min( abandonAbove, result.back().mDistance * result.back().mDistance * scale );
+
+            getRelativePitches( clipIntervals + start, segmentLength, &segmentPitches );
+            if( segmentLength == queryLength && getLowerBound( segmentPitches.data(), upper, lower, abandonAbove ) > abandonAbove )
+                continue;
+
+            float cost = getDtwCost( queryPitches.data(), numQueryNotes, segmentPitches.data(), segmentPitches.size(), band, abandonAbove );
+            if( cost < bestCost ) {
+                bestCost = cost;
+                bestStart = (size_t)start;
+            }
+        }
+
+        if( bestCost == numeric_limits<float>::infinity() )
+            continue;
+
+        Match match;
+        match.mClip = clip;
+        match.mDistance = sqrt( bestCost / scale );
+        match.mPosition = bestStart;
+        match.mVotes = candidate.mSupport;
+
+        auto position = upper_bound( result.begin(), result.end(), match, []( const Match &a, const Match &b ) { return a.mDistance < b.mDistance; } );
+        result.insert( position, match );
+        if( result.size() > options.mMaxResults )
+            result.pop_back();
+    }
+
+    for( auto &match : result )
+        match.mName = getClipName( match.mClip );
+
+    return result;
+}
+
+// ----------------------------------------------------------------------------------------------------
+// ContourIndexWriter
+// ----------------------------------------------------------------------------------------------------
+
+void ContourIndexWriter::add( const string &name, const vector<float> &intervals )
+{
+    const uint64_t limit = numeric_limits<uint32_t>::max();
+    if( mIntervals.size() + intervals.size() > limit || mNames.size() + name.size() > limit || mClips.size() >= limit )
+        throw ContourIndexExc( "corpus is too large for one index" );
+
+    ContourIndex::Clip clip;
+    clip.mIntervalOffset = (uint32_t)mIntervals.size();
+    clip.mNumIntervals = (uint32_t)intervals.size();
+    clip.mNameOffset = (uint32_t)mNames.size();
+    clip.mNameLength = (uint32_t)name.size();
+    mClips.push_back( clip );
+    mIntervals.insert( mIntervals.end(), intervals.begin(), intervals.end() );
+    mNames += name;
+}
+
+void ContourIndexWriter::write( const fs::path &path ) const
+{
+    const size_t gramLength = ContourIndex::kGramLength;
+
+    // counting sort: iterating clips and positions in order leaves each n-gram's postings sorted by clip and position
+    vector<uint32_t> gramStarts( ContourIndex::kNumGrams + 1, 0 );
+    for( const auto &clip : mClips ) {
+        for( size_t p = 0; p + gramLength <= clip.mNumIntervals; p++ )
+            gramStarts[getGram( &mIntervals[clip.mIntervalOffset + p] ) + 1]++;
+    }
+
+    for( size_t i = 1; i < gramStarts.size(); i++ ) {
+        if( (uint64_t)gramStarts[i] + gramStarts[i - 1] > numeric_limits<uint32_t>::max() )
+            throw ContourIndexExc( "corpus is too large for one index" );
+        gramStarts[i] += gramStarts[i - 1];
+    }
+
+    vector<ContourIndex::Posting> postings( gramStarts.back() );
+    vector<uint32_t> next( gramStarts.begin(), gramStarts.end() - 1 );
+    for( size_t c = 0; c < mClips.size(); c++ ) {
+        const auto &clip = mClips[c];
+        for( size_t p = 0; p + gramLength <= clip.mNumIntervals; p++ ) {
+            ContourIndex::Posting &posting = postings[next[getGram( &mIntervals[clip.mIntervalOffset + p] )]++];
+            posting.mClip = (uint32_t)c;
+            posting.mPosition = (uint32_t)p;
+        }
+    }
+
+    ContourIndex::Header header;
+    memset( &header, 0, sizeof( header ) );
+    memcpy( header.mMagic, kMagic, sizeof( kMagic ) );
+    header.mVersion = ContourIndex::kVersion;
+    header.mGramLength = (uint32_t)gramLength;
+    header.mMaxInterval = (uint32_t)ContourIndex::kMaxInterval;
+    header.mNumClips = mClips.size();
+    header.mNumPostings = postings.size();
+    header.mNumIntervals = mIntervals.size();
+    header.mNamesSize = mNames.size();
+
+    FILE *file = fopen( path.string().c_str(), "wb" );
+    if( ! file )
+        throw ContourIndexExc( "could not create " + path.string() );
+
+    // sections are padded to their offsets in the layout
+    Layout layout( header );
+    size_t position = 0;
+    bool ok = true;
+    auto writeSection = [&]( size_t offset, const void *data, size_t size ) {
+        static const char padding[8] = {};
+        if( ok && offset > position )
+            ok = fwrite( padding, 1, offset - position, file ) == offset - position;
+        if( ok && size )
+            ok = fwrite( data, 1, size, file ) == size;
+        position = offset + size;
+    };
+
+    writeSection( 0, &header, sizeof( header ) );
+    writeSection( layout.mGramStarts, gramStarts.data(), gramStarts.size() * sizeof( uint32_t ) );
+    writeSection( layout.mPostings, postings.data(), postings.size() * sizeof( ContourIndex::Posting ) );
+    writeSection( layout.mClips, mClips.data(), mClips.size() * sizeof( ContourIndex::Clip ) );
+    writeSection( layout.mIntervals, mIntervals.data(), mIntervals.size() * sizeof( float ) );
+    writeSection( layout.mNames, mNames.data(), mNames.size() );
+
+    if( fclose( file ) != 0 || ! ok )
+        throw ContourIndexExc( "could not write " + path.string() );
+}
@@ -0,0 +1,314 @@
+#include "FrameCapture.h"
+
+#include "cinder/gl/gl.h"
+#include "cinder/Log.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+#if defined( CINDER_MSW )
+    #define popen _popen
+    #define pclose _pclose
+#endif
+
+using namespace ci;
+using namespace std;
+
+namespace {
+
+// The GPU has a few frames to finish each readback, the encoder can fall behind by the rest before frames get dropped.
+const size_t sNumReadbacks  = 9;
+
+inline uint8_t clampByte( float v )
+{
+    return (uint8_t)max( 0.0f, min( 255.0f, v + 0.5f ) );
+}
+
+} // anonymous namespace
+
+FrameCapture::FrameCapture()
+    : mEncoding( Encoding::Y4M ), mRecording( false ), mOutput( nullptr ), mOutputIsPipe( false ), mNextReadback( 0 ),
+        mNumPending( 0 ), mNumQueued( 0 ), mNumCapturedFrames( 0 ), mNumDroppedFrames( 0 ), mNumCaptureCalls( 0 ),
+        mMaxCaptureTime( 0 ), mTotalCaptureTime( 0 ), mNumEncoded( 0 ), mStopEncoder( false )
+{
+}
+
+FrameCapture::~FrameCapture()
+{
+    stop();
+}
+
+bool FrameCapture::start( const string &destination, const ivec2 &pixelSize, float frameRate, Encoding encoding )
+{
+#if defined( CINDER_GL_ES_2 )
+    CI_LOG_W( "frame capture needs pixel buffer objects, which are not available on OpenGL ES 2" );
+    return false;
+#else
+    stop();
+
+    if( pixelSize.x <= 0 || pixelSize.y <= 0 )
+        return false;
+
+    mOutputIsPipe = ! destination.empty() && destination[0] == '|';
+#if defined( CINDER_COCOA_TOUCH )
+    if( mOutputIsPipe ) {
+        CI_LOG_E( "capturing to a command is not supported on iOS, use a file: " << destination );
+        return false;
+    }
+    mOutput = fopen( destination.c_str(), "wb" );
+#else
+    if( mOutputIsPipe )
+        mOutput = popen( destination.substr( 1 ).c_str(), "w" );
+    else
+        mOutput = fopen( destination.c_str(), "wb" );
+#endif
+
+    if( ! mOutput ) {
+        CI_LOG_E( "could not open capture destination: " << destination );
+        return false;
+    }
+
+    mSize = pixelSize;
+    mEncoding = encoding;
+    mNextReadback = mNumPending = mNumQueued = 0;
+    mNumCapturedFrames = mNumDroppedFrames = 0;
+    mNumCaptureCalls = 0;
+    mMaxCaptureTime = mTotalCaptureTime = 0;
+
+    const size_t frameBytes = (size_t)mSize.x * mSize.y * 4;
+    mReadbacks.clear();
+    for( size_t i = 0; i < sNumReadbacks; i++ )
+        mReadbacks.push_back( { gl::Pbo::create( GL_PIXEL_PACK_BUFFER, frameBytes, nullptr, GL_STREAM_READ ), nullptr, nullptr } );
+
+    mFilledReadbacks.clear();
+    mNumEncoded = 0;
+
+    if( mEncoding == Encoding::Y4M ) {
+        // frame rate as a rational with millisecond precision
+        fprintf( mOutput, "YUV4MPEG2 W%d H%d F%d:1000 Ip A1:1 C420jpeg\n", mSize.x, mSize.y, (int)lround( frameRate * 1000 ) );
+    }
+
+    mStopEncoder = false;
+    mEncoderThread = thread( &FrameCapture::encodeLoop, this );
+    mRecording = true;
+    return true;
+#endif
+}
+
+void FrameCapture::stop()
+{
+    if( ! mRecording )
+        return;
+
+    // drain what is still on the GPU, then let the encoder finish the queue
+    while( mNumPending > 0 )
+        retireReadback( true );
+
+    {
+        lock_guard<mutex> lock( mMutex );
+        mStopEncoder = true;
+    }
+    mCondition.notify_one();
+    mEncoderThread.join();
+    releaseEncoded();
+
+#if ! defined( CINDER_COCOA_TOUCH )
+    if( mOutputIsPipe )
+        pclose( mOutput );
+    else
+#endif
+        fclose( mOutput );
+
+    mOutput = nullptr;
+    mReadbacks.clear();
+    mRecording = false;
+
+    CI_LOG_I( "capture stopped, " << mNumCapturedFrames << " frames, " << mNumDroppedFrames << " dropped, render thread "
+                << getMeanCaptureTime() * 1000 << " ms per frame (" << mMaxCaptureTime * 1000 << " ms max)" );
+}
+
+void FrameCapture::captureFrame()
+{
+#if ! defined( CINDER_GL_ES_2 )
+    if( ! mRecording )
+        return;
+
+    auto startTime = chrono::steady_clock::now();
+    releaseEncoded();
+
+    // The next buffer in the ring is either free, still queued for the encoder (it fell behind) or, with the encoder
+    // caught up and the whole ring on the GPU, the oldest readback. Either way this frame is dropped. In the latter
+    // case the oldest readback is handed to the encoder so the ring moves on; it has had sNumReadbacks - 1 frames
+    // to complete, so this rarely waits. It can't be read into again until the encoder releases it.
+    if( mNumPending + mNumQueued == mReadbacks.size() ) {
+        if( ! mNumQueued )
+            retireReadback( true );
+        mNumDroppedFrames++;
+        return;
+    }
+
+    Readback &readback = mReadbacks[mNextReadback];
+    {
+        gl::ScopedBuffer pboScope( readback.mPbo );
+        glPixelStorei( GL_PACK_ALIGNMENT, 1 );
+        // with a pack buffer bound this returns immediately, the copy happens on the GPU
+        glReadPixels( 0, 0, mSize.x, mSize.y, GL_RGBA, GL_UNSIGNED_BYTE, nullptr );
+    }
+    readback.mFence = glFenceSync( GL_SYNC_GPU_COMMANDS_COMPLETE, 0 );
+
+    mNextReadback = ( mNextReadback + 1 ) % mReadbacks.size();
+    mNumPending++;
+
+    // hand over whatever finished in the meantime, without blocking
+    while( mNumPending > 1 && retireReadback( false ) )
+        ;
+
+    double elapsed = chrono::duration<double>( chrono::steady_clock::now() - startTime ).count();
+    mMaxCaptureTime = max( mMaxCaptureTime, elapsed );
+    mTotalCaptureTime += elapsed;
+    mNumCaptureCalls++;
+#endif
+}
+
+bool FrameCapture::retireReadback( bool wait )
+{
+#if defined( CINDER_GL_ES_2 )
+    return false;
+#else
+    size_t oldest = ( mNextReadback + mReadbacks.size() - mNumPending ) % mReadbacks.size();
+    Readback &readback = mReadbacks[oldest];
+
+    GLenum status = wait ? glClientWaitSync( readback.mFence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000 ) : glClientWaitSync( readback.mFence, 0, 0 );
+    bool signaled = status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED;
+    if( ! wait && ! signaled )
+        return false;
+
+    glDeleteSync( readback.mFence );
+    readback.mFence = nullptr;
+    mNumPending--;
+
+    // the mapping goes to the encoder as is, the pixels aren't copied on this thread. A readback that timed out or
+    // whose wait failed isn't mapped, the GPU may still be writing to it.
+    readback.mPixels = nullptr;
+    if( signaled ) {
+        gl::ScopedBuffer pboScope( readback.mPbo );
+        readback.mPixels = (const uint8_t *)readback.mPbo->mapBufferRange( 0, (size_t)mSize.x * mSize.y * 4, GL_MAP_READ_BIT );
+    }
+    mNumQueued++;
+
+    // a buffer that wasn't mapped is still queued, the encoder skips it and it is released in ring order
+    if( readback.mPixels )
+        mNumCapturedFrames++;
+    else
+        mNumDroppedFrames++;
+
+    {
+        lock_guard<mutex> lock( mMutex );
+        mFilledReadbacks.push_back( oldest );
+    }
+    mCondition.notify_one();
+    return true;
+#endif
+}
+
+void FrameCapture::releaseEncoded()
+{
+#if ! defined( CINDER_GL_ES_2 )
+    size_t numEncoded;
+    {
+        lock_guard<mutex> lock( mMutex );
+        numEncoded = mNumEncoded;
+        mNumEncoded = 0;
+    }
+
+    // the encoder works through the queue in ring order, the oldest queued buffers are the ones it finished
+    for( ; numEncoded > 0; numEncoded-- ) {
+        size_t oldest = ( mNextReadback + mReadbacks.size() - mNumPending - mNumQueued ) % mReadbacks.size();
+        Readback &readback = mReadbacks[oldest];
+        if( readback.mPixels ) {
+            gl::ScopedBuffer pboScope( readback.mPbo );
+            readback.mPbo->unmap();
+            readback.mPixels = nullptr;
+        }
+        mNumQueued--;
+    }
+#endif
+}
+
+void FrameCapture::encodeLoop()
+{
+    while( true ) {
+        size_t index;
+        {
+            unique_lock<mutex> lock( mMutex );
+            mCondition.wait( lock, [this] { return mStopEncoder || ! mFilledReadbacks.empty(); } );
+            if( mFilledReadbacks.empty() )
+                return;
+
+            index = mFilledReadbacks.front();
+        }
+
+        // the render thread doesn't touch a queued buffer until it is counted as encoded
+        if( mReadbacks[index].mPixels )
+            writeFrame( mReadbacks[index].mPixels );
+
+        lock_guard<mutex> lock( mMutex );
+        mFilledReadbacks.pop_front();
+        mNumEncoded++;
+    }
+}
+
+void FrameCapture::writeFrame( const uint8_t *pixels )
+{
+    const size_t width = mSize.x;
+    const size_t height = mSize.y;
+    const size_t stride = width * 4;
+
+    // GL rows start at the bottom
+    if( mEncoding == Encoding::RAW_RGBA ) {
+        for( size_t y = 0; y < height; y++ )
+            fwrite( pixels + ( height - 1 - y ) * stride, 1, stride, mOutput );
+        return;
+    }
+
+    // full range BT.601 4:2:0, chroma averaged over each 2x2 block
+    const size_t chromaWidth = ( width + 1 ) / 2;
+    const size_t chromaHeight = ( height + 1 ) / 2;
+    mPlanes.resize( width * height + 2 * chromaWidth * chromaHeight );
+    uint8_t *planeY = mPlanes.data();
+    uint8_t *planeU = planeY + width * height;
+    uint8_t *planeV = planeU + chromaWidth * chromaHeight;
+
+    for( size_t y = 0; y < height; y++ ) {
+        const uint8_t *row = pixels + ( height - 1 - y ) * stride;
+        for( size_t x = 0; x < width; x++ ) {
+            const uint8_t *p = row + x * 4;
+            planeY[y * width + x] = clampByte( 0.299f * p[0] + 0.587f * p[1] + 0.114f * p[2] );
+        }
+    }
+
+    for( size_t cy = 0; cy < chromaHeight; cy++ ) {
+        for( size_t cx = 0; cx < chromaWidth; cx++ ) {
+            float r = 0, g = 0, b = 0;
+            int count = 0;
+            for( size_t y = cy * 2; y < min( cy * 2 + 2, height ); y++ ) {
+                const uint8_t *row = pixels + ( height - 1 - y ) * stride;
+                for( size_t x = cx * 2; x < min( cx * 2 + 2, width ); x++ ) {
+                    r += row[x * 4];
+                    g += row[x * 4 + 1];
+                    b += row[x * 4 + 2];
+                    count++;
+                }
+            }
+            r /= count;
+            g /= count;
+            b /= count;
+            planeU[cy * chromaWidth + cx] = clampByte( 128 - 0.168736f * r - 0.331264f * g + 0.5f * b );
+            planeV[cy * chromaWidth + cx] = clampByte( 128 + 0.5f * r - 0.418688f * g - 0.081312f * b );
+        }
+    }
+
+    fputs( "FRAME\n", mOutput );
+    fwrite( mPlanes.data(), 1, mPlanes.size(), mOutput );
+}
@@ -0,0 +1,136 @@
+#include "FrequencyAxis.h"
+#include "NoteTables.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+FrequencyAxis::FrequencyAxis()
+    : mNumBins( 0 ), mNyquist( 0 ), mMinFreq( 20 ), mLowFreq( 0 ), mHighFreq( 0 ), mLowNote( 24 ), mHighNote( 108 ), mScale( Scale::LINEAR ), mRevision( 0 )
+{
+}
+
+bool FrequencyAxis::setup( size_t numBins, size_t numColumns, float nyquist, Scale scale )
+{
+    if( numBins == mNumBins && numColumns == mColumnBegin.size() && nyquist == mNyquist && scale == mScale )
+        return false;
+
+    mRevision++;
+    mNumBins = numBins;
+    mNyquist = nyquist;
+    mScale = scale;
+    mColumnBegin.resize( numColumns );
+    mColumnEnd.resize( numColumns );
+    mColumnBin.resize( numColumns );
+    mBinColumn.resize( numBins );
+    mGridLines.clear();
+
+    if( numBins == 0 || numColumns == 0 || nyquist <= 0 )
+        return true;
+
+    switch( mScale ) {
+        case Scale::LINEAR: mLowFreq = 0;                               mHighFreq = nyquist;                                    break;
+        case Scale::LOG:    mLowFreq = mMinFreq;                        mHighFreq = nyquist;                                    break;
+        case Scale::NOTES:  mLowFreq = getNoteFreq( mLowNote );   mHighFreq = min( nyquist, getNoteFreq( mHighNote ) ); break;
+    }
+
+    const float binsPerHertz = numBins / nyquist;
+    const float columnsPerUnit = (float)numColumns;
+    for( size_t col = 0; col < numColumns; col++ ) {
+        float binBegin = getFreqForNormalized( col / columnsPerUnit ) * binsPerHertz;
+        float binEnd = getFreqForNormalized( ( col + 1 ) / columnsPerUnit ) * binsPerHertz;
+        float binCenter = getFreqForNormalized( ( col + 0.5f ) / columnsPerUnit ) * binsPerHertz;
+
+        uint32_t begin = (uint32_t)min<float>( floor( binBegin ), (float)numBins - 1 );
+        uint32_t end = (uint32_t)min<float>( ceil( binEnd ), (float)numBins );
+        mColumnBegin[col] = begin;
+        mColumnEnd[col] = max( end, begin + 1 );
+        mColumnBin[col] = (uint32_t)min<float>( binCenter, (float)numBins - 1 );
+    }
+
+    const float hertzPerBin = nyquist / numBins;
+    for( size_t bin = 0; bin < numBins; bin++ )
+        mBinColumn[bin] = getNormalizedForFreq( ( bin + 0.5f ) * hertzPerBin ) * columnsPerUnit;
+
+    buildGridLines();
+    return true;
+}
+
+size_t FrequencyAxis::getBinForColumn( float column ) const
+{
+    if( mColumnBin.empty() )
+        return 0;
+
+    size_t col = (size_t)max( 0.0f, min( column, (float)mColumnBin.size() - 1 ) );
+    return mColumnBin[col];
+}
+
+float FrequencyAxis::getColumnForBin( float bin ) const
+{
+    if( mBinColumn.empty() )
+        return 0;
+
+    // table entries are at bin centers, interpolate between the two neighbours
+    float pos = max( 0.0f, min( bin - 0.5f, (float)mBinColumn.size() - 1 ) );
+    size_t index = (size_t)pos;
+    size_t next = min( index + 1, mBinColumn.size() - 1 );
+    float frac = pos - (float)index;
+    return mBinColumn[index] + ( mBinColumn[next] - mBinColumn[index] ) * frac;
+}
+
+float FrequencyAxis::getColumnForFreq( float freq ) const
+{
+    if( mNyquist <= 0 )
+        return 0;
+
+    return getColumnForBin( freq * mNumBins / mNyquist );
+}
+
+float FrequencyAxis::getFreqForColumn( float column ) const
+{
+    return getFreqForNormalized( column / (float)max<size_t>( 1, mColumnBegin.size() ) );
+}
+
+float FrequencyAxis::getFreqForNormalized( float t ) const
+{
+    if( mScale == Scale::LINEAR )
+        return mLowFreq + t * ( mHighFreq - mLowFreq );
+
+    return mLowFreq * pow( mHighFreq / mLowFreq, t );
+}
+
+float FrequencyAxis::getNormalizedForFreq( float freq ) const
+{
+    if( mScale == Scale::LINEAR )
+        return ( freq - mLowFreq ) / ( mHighFreq - mLowFreq );
+
+    return log( max( freq, 1.0f ) / mLowFreq ) / log( mHighFreq / mLowFreq );
+}
+
+void FrequencyAxis::buildGridLines()
+{
+    const float numColumns = (float)mColumnBegin.size();
+    auto addLine = [&]( float freq, int midiNote, bool major ) {
+        float t = getNormalizedForFreq( freq );
+        if( t >= 0 && t <= 1 )
+            mGridLines.push_back( { t * numColumns, freq, midiNote, major } );
+    };
+
+    switch( mScale ) {
+        case Scale::LINEAR:
+            for( float freq = 1000; freq < mHighFreq; freq += 1000 )
+                addLine( freq, -1, fmod( freq, 5000.0f ) == 0 );
+            break;
+        case Scale::LOG:
+            for( float decade = 10; decade < mHighFreq; decade *= 10 ) {
+                for( int i = 1; i < 10; i++ )
+                    addLine( decade * i, -1, i == 1 );
+            }
+            break;
+        case Scale::NOTES:
+            for( int note = mLowNote; note <= mHighNote; note++ )
+                addLine( getNoteFreq( note ), note, note % 12 == 0 );
+            break;
+    }
+}
@@ -0,0 +1,62 @@
+#include "GlyphRunCache.h"
+
+using namespace ci;
+using namespace std;
+
+GlyphRunCache::GlyphRunCache( size_t capacity )
+    : mCapacity( capacity ), mNumHits( 0 ), mNumMisses( 0 ), mClock( 0 )
+{
+}
+
+void GlyphRunCache::setFont( const gl::TextureFontRef &font )
+{
+    if( font == mFont )
+        return;
+
+    mFont = font;
+    mRuns.clear();
+}
+
+void GlyphRunCache::drawString( const string &str, const vec2 &baseline )
+{
+    if( ! mFont || str.empty() )
+        return;
+
+    mFont->drawGlyphs( getRun( str ).mPlacements, baseline );
+}
+
+vec2 GlyphRunCache::measureString( const string &str )
+{
+    if( ! mFont || str.empty() )
+        return vec2( 0 );
+
+    return getRun( str ).mSize;
+}
+
+const GlyphRunCache::Run& GlyphRunCache::getRun( const string &str )
+{
+    mClock++;
+
+    auto it = mRuns.find( str );
+    if( it != mRuns.end() ) {
+        mNumHits++;
+        it->second.mLastUsed = mClock;
+        return it->second;
+    }
+
+    mNumMisses++;
+    if( mRuns.size() >= mCapacity ) {
+        auto oldest = mRuns.begin();
+        for( auto runIt = mRuns.begin(); runIt != mRuns.end(); ++runIt ) {
+            if( runIt->second.mLastUsed < oldest->second.mLastUsed )
+                oldest = runIt;
+        }
+        mRuns.erase( oldest );
+    }
+
+    Run &run = mRuns[str];
+    run.mPlacements = mFont->getGlyphPlacements( str );
+    run.mSize = mFont->measureString( str );
+    run.mLastUsed = mClock;
+    return run;
+}
@@ -21,120 +21,434 @@ author: Tom Estlack 2021
 #include "cinder/app/RendererGl.h"
 #include "cinder/gl/TextureFont.h"
 #include "cinder/audio/audio.h"
-#include "../../common/AudioDrawUtils.h"
+#include "AnalysisPipeline.h"
+#include "BackgroundLoader.h"
+#include "BufferAutoTuner.h"
+#include "ConfigWatcher.h"
+#include "FrameCapture.h"
+#include "GlyphRunCache.h"
+#include "NoteTables.h"
+#include "OverlayLayer.h"
+#include "RenderScheduler.h"
+#include "SceneLayout.h"
+#include "ShapeBatch.h"
+#include "SpectrumEnvelopePlot.h"
+#include "StartupMetrics.h"
+
+#include <ctime>
+#include <future>
+#include <map>
 
 using namespace ci;
 using namespace ci::app;
 using namespace std;
 
+//! Per-window state. Windows only read the pipeline's shared AnalysisFrame, they never pull from the audio graph.
+struct WindowScene {
+    //! SPECTRUM draws the plot, labels and shapes, SHAPES only the reactive shapes (e.g. for a projector).
+    enum class Type { SPECTRUM, SHAPES };
+
+    WindowScene( Type type ) : mType( type ), mTunerGlyphRuns( 160 ) {}
+
+    Type                    mType;
+    SceneLayout             mLayout;
+    SpectrumEnvelopePlot    mSpectrumPlot;
+    ShapeBatch              mShapeBatch;
+    OverlayLayer            mOverlay;
+    GlyphRunCache           mGlyphRuns;
+    GlyphRunCache           mTunerGlyphRuns;    // note names and whole cents, in the large font
+};
+
 class InputAnalyzer : public App {
   public:
     void setup() override;
     void mouseDown( MouseEvent event ) override;
+    void keyDown( KeyEvent event ) override;
+    void resize() override;
     void update() override;
     void draw() override;
+    void cleanup() override;
 
-    void drawSpectralCentroid();
-    void drawLabels();
-    void printBinInfo( int mouseX );
-
-    audio::InputDeviceNodeRef        mInputDeviceNode;
-    audio::MonitorSpectralNodeRef    mMonitorSpectralNode;
-    vector<float>                    mMagSpectrum;
+    WindowScene* getScene() const   { return getWindow()->getUserData<WindowScene>(); }
+    void openWindow( WindowScene::Type type );
+    void layoutScene( WindowScene *scene, const ivec2 &windowSize );
+    void toggleCapture();
+    void finishStartup();
+    string getTitle() const;
+    //! The overlay's font rasterized at \a contentScale, created on first use for displays other than the startup one.
+    gl::TextureFontRef getOverlayFont( float contentScale );
 
-    SpectrumPlot                    mSpectrumPlot;
-    gl::TextureFontRef                mTextureFont;
+    void drawSpectralCentroid( WindowScene *scene, const AnalysisFrame &frame );
+    void drawLabels( WindowScene *scene, const AnalysisFrame &frame );
+    void printBinInfo( WindowScene *scene, const AnalysisFrame &frame, int mouseX );
+    void drawTuner( WindowScene *scene, const AnalysisFrame &frame );
 
+    AnalysisPipeline                mPipeline;
+    ConfigWatcher                   mConfigWatcher;
+    BufferAutoTuner                 mBufferTuner;
+    ThreadPolicy                    mRenderThreadPolicy, mAnalysisThreadPolicy;
+    uint32_t                        mInputRevision = 0;
+    future<void>                    mPipelineSetup;
+    bool                            mPipelineReady = false;
+    gl::TextureFontRef                mTextureFont; // shared by every window, their GL contexts share resources
+    map<float, gl::TextureFontRef>  mOverlayFonts;  // by content scale
+    gl::TextureFontRef              mTunerFont;
+    float                           mOverlayFontScale = 1;  // of the font loaded in the background
+    bool                            mDrawn = false;
+    bool                            mTunerMode = false;
+    unique_ptr<BackgroundLoader>    mLoader;
+    future<gl::TextureFontRef>      mTextureFontLoad, mOverlayFontLoad, mTunerFontLoad;
+    RenderScheduler                 mRenderScheduler;
+    FrameCapture                    mFrameCapture;
+    WindowRef                       mCaptureWindow;
 };
 
 void InputAnalyzer::setup()
 {
-    auto ctx = audio::Context::master();
-    // The InputDeviceNode is platform-specific, so you create it using a special method on the Context:
-    mInputDeviceNode = ctx->createInputDeviceNode();
-    // By providing an FFT size double that of the window size, we 'zero-pad' the analysis data, which gives
-    // an increase in resolution of the resulting spectrum data.
-    auto monitorFormat = audio::MonitorSpectralNode::Format().fftSize( 2048 ).windowSize( 1024 );
-    mMonitorSpectralNode = ctx->makeNode( new audio::MonitorSpectralNode( monitorFormat ) );
-    mInputDeviceNode >> mMonitorSpectralNode;
-    // InputDeviceNode (and all InputNode subclasses) need to be enabled()'s to process audio. So does the Context:
-    mInputDeviceNode->enable();
-    ctx->enable();
-    getWindow()->setTitle( mInputDeviceNode->getDevice()->getName() );
+    StartupMetrics::instance().mark( "setup" );
+
+    // edits to the file apply while running, see update()
+    mConfigWatcher.start( AnalysisConfig::getDefaultPath() );
+    console() << "analysis config: " << mConfigWatcher.getPath() << endl;
+
+    // the audio graph comes up on its own thread while the first frames are drawn, see finishStartup()
+    mPipelineSetup = async( launch::async, [this] { mPipeline.setup(); } );
+
+    // fonts are rasterized and uploaded on a shared context, text is left out until they are ready
+    mLoader.reset( new BackgroundLoader );
+    mOverlayFontScale = getWindowContentScale();
+    mTextureFontLoad = mLoader->enqueue<gl::TextureFontRef>( [] {
+        return gl::TextureFont::create( ci::Font( ci::Font::getDefault().getName(), 16 ) );
+    } );
+    float overlayFontSize = 16 * mOverlayFontScale;
+    mOverlayFontLoad = mLoader->enqueue<gl::TextureFontRef>( [overlayFontSize] {
+        return gl::TextureFont::create( ci::Font( ci::Font::getDefault().getName(), overlayFontSize ) );
+    } );
+    // the tuner's large digits only need note names, octaves and cents, which keeps the atlas small at this size
+    mTunerFontLoad = mLoader->enqueue<gl::TextureFontRef>( [] {
+        return gl::TextureFont::create( ci::Font( ci::Font::getDefault().getName(), 160 ), gl::TextureFont::Format(), "ABCDEFG#0123456789+-" );
+    } );
+
+    getWindow()->setTitle( getTitle() );
+    getWindow()->setUserData( new WindowScene( WindowScene::Type::SPECTRUM ) );
+    layoutScene( getScene(), getWindowSize() );
+    setFrameRate( mRenderScheduler.getTargetFrameRate() );
+}
+
+void InputAnalyzer::finishStartup()
+{
+    if( ! mPipelineReady && isReady( mPipelineSetup ) ) {
+        // rethrows here if the input couldn't be opened
+        mPipelineSetup.get();
+        mPipelineReady = true;
+        StartupMetrics::instance().mark( "audio_ready" );
+
+        for( size_t i = 0; i < getNumWindows(); i++ )
+            getWindowIndex( i )->setTitle( getTitle() );
+
+        // the stored block size for this device, or a first-run probe for the smallest stable one
+        mBufferTuner.start( mPipeline.getInputDeviceNode(), mPipeline.getTimingNode() );
+    }
+
+    if( isReady( mTextureFontLoad ) )
+        mTextureFont = mTextureFontLoad.get();
+    if( isReady( mOverlayFontLoad ) )
+        mOverlayFonts[mOverlayFontScale] = mOverlayFontLoad.get();
+    if( isReady( mTunerFontLoad ) )
+        mTunerFont = mTunerFontLoad.get();
+
+    // nothing else is loaded in the background, let the loader's thread and context go
+    if( mLoader && mTextureFont && ! mOverlayFonts.empty() && mTunerFont ) {
+        mLoader.reset();
+        StartupMetrics::instance().mark( "fonts_ready" );
+    }
+}
+
+gl::TextureFontRef InputAnalyzer::getOverlayFont( float contentScale )
+{
+    // glyphs are rasterized at the display's pixel density and drawn scaled back down to points
+    gl::TextureFontRef &font = mOverlayFonts[contentScale];
+    if( ! font )
+        font = gl::TextureFont::create( ci::Font( ci::Font::getDefault().getName(), 16 * contentScale ) );
+
+    return font;
+}
+
+string InputAnalyzer::getTitle() const
+{
+    // the device isn't known until the pipeline is set up
+    if( ! mPipelineReady )
+        return "InputAnalyzer";
+
+    return mPipeline.getInputDeviceNode()->getDevice()->getName();
+}
+
+void InputAnalyzer::openWindow( WindowScene::Type type )
+{
+    // spread additional windows over the available displays
+    const auto &displays = Display::getDisplays();
+    DisplayRef display = displays[getNumWindows() % displays.size()];
+
+    WindowRef window = createWindow( Window::Format().size( 1024, 768 ).display( display ) );
+    window->setTitle( getTitle() );
+    window->setUserData( new WindowScene( type ) );
+    layoutScene( window->getUserData<WindowScene>(), window->getSize() );
 }
 
 void InputAnalyzer::mouseDown( MouseEvent event )
 {
-    if( mSpectrumPlot.getBounds().contains( event.getPos() ) )
-        printBinInfo( event.getX() );
+    mRenderScheduler.wake();
+
+    WindowScene *scene = getScene();
+    if( scene && scene->mType == WindowScene::Type::SPECTRUM && scene->mSpectrumPlot.getBounds().contains( event.getPos() ) )
+        printBinInfo( scene, *mPipeline.getFrame(), event.getX() );
+}
+
+void InputAnalyzer::keyDown( KeyEvent event )
+{
+    mRenderScheduler.wake();
+
+    WindowScene *scene = getScene();
+    if( ! scene )
+        return;
+
+    // 's' cycles the plot's frequency axis: linear -> log -> note grid
+    if( event.getChar() == 's' ) {
+        auto &plot = scene->mSpectrumPlot;
+        switch( plot.getScale() ) {
+            case FrequencyAxis::Scale::LINEAR:  plot.setScale( FrequencyAxis::Scale::LOG );     break;
+            case FrequencyAxis::Scale::LOG:     plot.setScale( FrequencyAxis::Scale::NOTES );   break;
+            case FrequencyAxis::Scale::NOTES:   plot.setScale( FrequencyAxis::Scale::LINEAR );  break;
+        }
+    }
+    // 'r' toggles between redrawing continuously and only when there is something new to show
+    else if( event.getChar() == 'r' ) {
+        bool continuous = mRenderScheduler.getMode() == RenderScheduler::Mode::CONTINUOUS;
+        mRenderScheduler.setMode( continuous ? RenderScheduler::Mode::ON_DEMAND : RenderScheduler::Mode::CONTINUOUS );
+        console() << "render mode: " << ( continuous ? "on demand" : "continuous" ) << endl;
+    }
+    // 'w' opens another window with only the reactive shapes, fed by the same analysis
+    else if( event.getChar() == 'w' ) {
+        openWindow( WindowScene::Type::SHAPES );
+    }
+    // 'f' steps through FFT resolutions live, the window is half the FFT size (zero-padded like the original 2048 / 1024)
+    else if( event.getChar() == 'f' && mPipelineReady ) {
+        size_t fftSize = mPipeline.getAnalyzerFormat().mFftSize * 2;
+        if( fftSize > AnalysisPipeline::kMaxWindowSize * 2 )
+            fftSize = 1024;
+
+        mPipeline.reconfigure( SpectralAnalyzer::Format().fftSize( fftSize ).windowSize( fftSize / 2 ) );
+        console() << "fft size: " << fftSize << ", window size: " << fftSize / 2 << endl;
+    }
+    // 'b' probes the input's block size again, replacing the stored one
+    else if( event.getChar() == 'b' && mPipelineReady && ! mPipeline.isRebuilding() && ! mBufferTuner.isProbing() ) {
+        mBufferTuner.start( mPipeline.getInputDeviceNode(), mPipeline.getTimingNode(), true );
+    }
+    // 'i' prints how often each stage of the pitch cascade resolved a frame, and what it cost
+    else if( event.getChar() == 'i' ) {
+        console() << "pitch engine: " << mPipeline.getPitchEngine().getStats().format() << endl;
+    }
+    // 't' toggles the tuner: note, octave and cents from the pitch cascade in place of the spectrum
+    else if( event.getChar() == 't' ) {
+        mTunerMode = ! mTunerMode;
+        console() << "tuner: " << ( mTunerMode ? "on" : "off" ) << ", A4 = " << mPipeline.getConfig()->mTunerReference << " Hz" << endl;
+    }
+    // 'c' starts / stops recording this window to a .y4m file in the documents directory
+    else if( event.getChar() == 'c' ) {
+        toggleCapture();
+    }
+}
+
+void InputAnalyzer::toggleCapture()
+{
+    if( mFrameCapture.isRecording() ) {
+        mFrameCapture.stop();
+        mCaptureWindow.reset();
+        return;
+    }
+
+    fs::path path = getDocumentsDirectory() / ( "InputAnalyzer-" + to_string( time( nullptr ) ) + ".y4m" );
+    ivec2 pixelSize = toPixels( getWindowSize() );
+    if( mFrameCapture.start( path.string(), pixelSize, mRenderScheduler.getOptions().mMaxFrameRate ) ) {
+        mCaptureWindow = getWindow();
+        console() << "recording to " << path << endl;
+    }
+}
+
+void InputAnalyzer::resize()
+{
+    // a window may be resized before its scene is attached, openWindow() lays it out in that case
+    WindowScene *scene = getScene();
+    if( scene )
+        layoutScene( scene, getWindowSize() );
+
+    // the stream's frame size is fixed
+    if( mFrameCapture.isRecording() && getWindow() == mCaptureWindow ) {
+        console() << "capture window resized, stopping recording" << endl;
+        toggleCapture();
+    }
+
+    mRenderScheduler.wake();
+}
+
+void InputAnalyzer::layoutScene( WindowScene *scene, const ivec2 &windowSize )
+{
+    // layout only changes here; readings no longer depend on it, see AnalysisPipeline::analyze()
+    scene->mLayout = SceneLayout( windowSize );
+    scene->mSpectrumPlot.setBounds( scene->mLayout.mPlotBounds );
 }
 
 void InputAnalyzer::update()
 {
-    //  changed from InputAnalyzer - window dimensions to be set at 1024 x 768 for consistent readings
-    mSpectrumPlot.setBounds( Rectf( 40, 40, (float)1024 - 40, (float)768 - 40 ) );
-    // We copy the magnitude spectrum out from the Node on the main thread, once per update:
-    mMagSpectrum = mMonitorSpectralNode->getMagSpectrum();
+    finishStartup();
+
+    // runs once per app tick regardless of how many windows there are
+    if( mPipelineReady ) {
+        mPipeline.setConfig( mConfigWatcher.getConfig() );
+
+        // the worker owns the context and the input until the pipeline has swapped its result in
+        if( mPipeline.isRebuilding() )
+            mBufferTuner.suspend();
+        else {
+            // the pipeline replaced its input (device unplugged, or back), the scenes and analysis carry on
+            if( mPipeline.getInputRevision() != mInputRevision ) {
+                mInputRevision = mPipeline.getInputRevision();
+                mBufferTuner.setInput( mPipeline.getInputDeviceNode() );
+                for( size_t i = 0; i < getNumWindows(); i++ )
+                    getWindowIndex( i )->setTitle( getTitle() );
+            }
+
+            mBufferTuner.update( getElapsedSeconds() );
+        }
+    }
+
+    // this thread renders and also runs the analysis step, the audio thread's policy is applied by the pipeline
+    const ThreadPolicy &renderThreadPolicy = mPipeline.getConfig()->mRenderThread;
+    if( renderThreadPolicy != mRenderThreadPolicy ) {
+        mRenderThreadPolicy = renderThreadPolicy;
+        console() << "render thread: " << applyThreadPolicy( mRenderThreadPolicy ).describe() << endl;
+    }
+
+    // the daemon's analysis thread has no counterpart here, only the analyzer preparation worker follows it
+    const ThreadPolicy &analysisThreadPolicy = mPipeline.getConfig()->mAnalysisThread;
+    if( analysisThreadPolicy != mAnalysisThreadPolicy ) {
+        mAnalysisThreadPolicy = analysisThreadPolicy;
+        if( ! mAnalysisThreadPolicy.isDefault() )
+            console() << "threads.analysis only applies to preparing analyzers in the app, the analysis step runs on the render thread (threads.render)" << endl;
+    }
+
+    // the frame rates are tunables like the rest, they follow edits to the config
+    AnalysisConfigRef config = mPipeline.getConfig();
+    RenderScheduler::Options schedulerOptions = mRenderScheduler.getOptions();
+    if( schedulerOptions.mMaxFrameRate != config->mMaxFrameRate || schedulerOptions.mIdleFrameRate != config->mIdleFrameRate ) {
+        schedulerOptions.mMaxFrameRate = config->mMaxFrameRate;
+        schedulerOptions.mIdleFrameRate = config->mIdleFrameRate;
+        mRenderScheduler.setOptions( schedulerOptions );
+    }
+
+    bool newAnalysisFrame = mPipelineReady && mPipeline.update();
+
+    // launch -> first detected pitch, the number startup changes are measured against
+    if( newAnalysisFrame && ! StartupMetrics::instance().hasMark( "first_pitch" ) ) {
+        StartupMetrics::instance().mark( "first_frame" );
+        if( mPipeline.getFrame()->mPitchLevel > mPipeline.getConfig()->mPitchThreshold ) {
+            StartupMetrics::instance().mark( "first_pitch" );
+            console() << StartupMetrics::instance().format() << endl;
+        }
+    }
+
+    // recordings need every frame at the full rate
+    if( mFrameCapture.isRecording() )
+        mRenderScheduler.wake();
+
+    // drop to the idle rate when the input is silent and nothing is animating, back to the cap as soon as it isn't
+    mRenderScheduler.update( getElapsedSeconds(), newAnalysisFrame, mPipeline.getFrame()->mInputLevel );
+    float frameRate = mRenderScheduler.getTargetFrameRate();
+    if( frameRate != getFrameRate() )
+        setFrameRate( frameRate );
 }
 
 void InputAnalyzer::draw()
 {
     gl::clear();
+    if( ! mDrawn ) {
+        StartupMetrics::instance().mark( "first_draw" );
+        mDrawn = true;
+    }
+
+    WindowScene *scene = getScene();
+    if( ! scene )
+        return;
+
+    // hold on to the frame for the whole draw, every window reads the same one
+    AnalysisFrameRef frame = mPipeline.getFrame();
+
     gl::enableAlphaBlending();
-    mSpectrumPlot.draw( mMagSpectrum );
-    drawSpectralCentroid();
-    drawLabels();
-}
-
-void InputAnalyzer::drawSpectralCentroid()
-{
-    // The spectral centroid is largely correlated with 'brightness' of a sound. It is the center of mass of all frequency values.
-    // See the note on audio::MonitorSpectralNode::getSpectralCentroid() - it may be analyzing a more recent magnitude spectrum
-    // than what we're drawing in the SpectrumPlot. It is not a problem for this simple sample, but if you need a more precise
-    // value, use audio::dsp::spectralCentroid() directly.
-    float spectralCentroid = mMonitorSpectralNode->getSpectralCentroid();
-    float nyquist = (float)audio::master()->getSampleRate() / 2.0f;
-    Rectf bounds = mSpectrumPlot.getBounds();
-    // revised variable MyQuisp - .745 ended up being a "sweet spot" but is off by roughly 10-4 hz
-    // ie. low e on guitar is 82hz, reports as 86hz - high e is 322hz, reports as 362hz (or something)
-    float MyQuisp = (float)audio::master()->getSampleRate() / 0.745f;
-    float frNormT = spectralCentroid / MyQuisp; // Needed to read freq
-    float freqNormalized = spectralCentroid / nyquist;
-    float barCenter = bounds.x1 + freqNormalized * bounds.getWidth();
-    // try to read frequencies -> Eakin
-    Rectf verticalBar = { barCenter - 2, bounds.y1, barCenter + 2, bounds.y2 };
-    gl::ScopedColor colorScope( 0.85f, 0.45f, 0, 0.4f ); // transparent orange
-    gl::drawSolidRect( verticalBar );
-    
-    // locate frequency bin with somewhat better accuracy to measure frequency;
-    float FBins = (bounds.x1 + frNormT * 1024) - 40;
-    // snag frequency using location of spectral node (above) as coord for bin#
-    float FCalc = mMonitorSpectralNode->getFreqForBin(FBins);// was FBins
-    // might need to correct since bounds could change dep on scr size
-    // measure volume mag of bin# (where dominant frequency is located
-    float FVolm = audio::linearToDecibel( mMagSpectrum[FBins] );
-    
-    gl::color(1,1,1);
-    gl::drawSolidCircle(vec2(FBins, FVolm), 50); // follows bin location
+    if( mTunerMode && scene->mType == WindowScene::Type::SPECTRUM ) {
+        drawTuner( scene, *frame );
+    }
+    else if( scene->mType == WindowScene::Type::SPECTRUM ) {
+        // the plot is decimated to its pixel width, so its cost doesn't grow with the FFT size
+        scene->mSpectrumPlot.draw( frame->mMagSpectrum, frame->getNyquist() );
+    }
+
+    if( ! mTunerMode || scene->mType == WindowScene::Type::SHAPES )
+        drawSpectralCentroid( scene, *frame );
+
+    if( ! mTunerMode && scene->mType == WindowScene::Type::SPECTRUM )
+        drawLabels( scene, *frame );
+
+    // queues an asynchronous readback of what was just drawn, picked up a frame or two later
+    if( mFrameCapture.isRecording() && getWindow() == mCaptureWindow )
+        mFrameCapture.captureFrame();
+}
+
+void InputAnalyzer::cleanup()
+{
+    mFrameCapture.stop();
+    mLoader.reset();
+    mConfigWatcher.stop();
+}
+
+void InputAnalyzer::drawSpectralCentroid( WindowScene *scene, const AnalysisFrame &frame )
+{
+    if( frame.mMagSpectrum.empty() )
+        return;
+
+    const SceneLayout &layout = scene->mLayout;
+    const FrequencyAxis &axis = scene->mSpectrumPlot.getAxis();
+    ShapeBatch &shapes = scene->mShapeBatch;
+
+    // pitch values come from the analysis (see AnalysisPipeline::analyze()), this only maps them to the screen
+    float spectralCentroid = frame.mSpectralCentroid;
+    float FBins = frame.mPitchBin;
+    float FCalc = frame.mPitchFreq;
+    float FVolm = frame.mPitchLevel;
+
+    // analysis -> screen happens only here, through the cached layout and axis tables
+    const float shapeScale = layout.mShapeScale;
+    if( scene->mType == WindowScene::Type::SPECTRUM ) {
+        const Rectf &bounds = layout.mPlotBounds;
+        float barCenter = bounds.x1 + axis.getColumnForFreq( spectralCentroid );
+        // try to read frequencies -> Eakin
+        Rectf verticalBar = { barCenter - 2, bounds.y1, barCenter + 2, bounds.y2 };
+        shapes.addRect( verticalBar, ColorA( 0.85f, 0.45f, 0, 0.4f ) ); // transparent orange
+
+        vec2 binPos( bounds.x1 + axis.getColumnForBin( FBins ), layout.getPlotY( FVolm ) );
+        shapes.addCircle( binPos, 50 * shapeScale, ColorA( 1, 1, 1 ) ); // follows bin location
+    }
     /* uncomment to see measurements
      if (FVolm > 0) {
         console() << "FCalc-" << FCalc << "|vol-" << FVolm << "|FBins-" << FBins << " ";
     }
      */
-    // low e and mid a guitar
-    if ((FCalc > 200) && (FCalc < 400) && (FVolm > 10)) {
-        gl::color(1,0,0);
-        gl::drawSolidCircle(vec2(getWindowCenter().x,getWindowCenter().y*.5), FVolm);
-    }
-    // mid a and high a
-    if ((FCalc < 200)  && (FVolm > 10)) {
-        gl::color(0,1,0);
-        gl::drawSolidCircle(vec2(getWindowCenter().x*.5,getWindowCenter().y*.5), FVolm);
-    }
-    // high a and way up there
-    if ((FCalc > 400)  && (FVolm > 10)) {
-        gl::color(0,0,1);
-        gl::drawSolidCircle(vec2(getWindowCenter().x*1.5,getWindowCenter().y*.5), FVolm);
+    // the bands (low e and mid a guitar, below, above) and their colors are the config's triggers now
+    for( const auto &trigger : mPipeline.getConfig()->mTriggers ) {
+        if( ! trigger.matches( FCalc, FVolm ) )
+            continue;
+
+        const vec2 &pos = trigger.mSlot == PitchTrigger::Slot::LOW ? layout.mLowBandPos : trigger.mSlot == PitchTrigger::Slot::MID ? layout.mMidBandPos : layout.mHighBandPos;
+        shapes.addCircle( pos, FVolm * shapeScale, trigger.mColor );
     }
 
     // frequency reference
@@ -145,44 +459,98 @@ void InputAnalyzer::drawSpectralCentroid()
     
     // float freqDetect = mMonitorSpectralNode->getFreqForBin(250);
     //gl::clear();
-    gl::color(Color(1.0f, 0.0f, .7f));
-    //gl::drawSolidRect(Rectf(0,0,200,200) );
-    gl::drawSolidCircle(getWindowCenter(), spectralCentroid/200);
-    gl::color(Color(0, 1.0f, .5f));
-    gl::drawSolidCircle(vec2(getWindowCenter().x*1.5f,getWindowCenter().y), spectralCentroid/300);
-    gl::color(Color(0,spectralCentroid/10000,1.0f));
-    gl::drawSolidCircle(vec2(getWindowCenter().x*0.5f,getWindowCenter().y), 100);
+    shapes.addCircle( layout.mCentroidPos, spectralCentroid / 200 * shapeScale, ColorA( 1.0f, 0.0f, .7f ) );
+    shapes.addCircle( layout.mCentroidRightPos, spectralCentroid / 300 * shapeScale, ColorA( 0, 1.0f, .5f ) );
+    shapes.addCircle( layout.mCentroidLeftPos, 100 * shapeScale, ColorA( 0, spectralCentroid / 10000, 1.0f ) );
+
+    // everything above goes out in a single instanced draw call
+    shapes.draw();
 }
 
-void InputAnalyzer::drawLabels()
+void InputAnalyzer::drawLabels( WindowScene *scene, const AnalysisFrame &frame )
 {
-    if( ! mTextureFont )
-        mTextureFont = gl::TextureFont::create( ci::Font( ci::Font::getDefault().getName(), 16 ) );
+    // axis labels and grid are cached in the overlay's Fbo, only re-rendered when the layout changes
+    if( ! mTextureFont || mOverlayFonts.empty() )
+        return;
 
-    gl::color( 0, 0.9f, 0.9f );
+    scene->mOverlay.setFont( getOverlayFont( getWindowContentScale() ) );
+    scene->mOverlay.draw( getWindowSize(), getWindowContentScale(), scene->mLayout.mPlotBounds, scene->mSpectrumPlot.getAxis() );
 
-    // draw x-axis label
-    string freqLabel = "Frequency (hertz)";
-    mTextureFont->drawString( freqLabel, vec2( getWindowCenter().x - mTextureFont->measureString( freqLabel ).x / 2, (float)getWindowHeight() - 20 ) );
+    scene->mGlyphRuns.setFont( mTextureFont );
 
-    // draw y-axis label
-    string dbLabel = "Magnitude (decibels, linear)";
-    gl::pushModelView();
-        gl::translate( 30, getWindowCenter().y + mTextureFont->measureString( dbLabel ).x / 2 );
-        gl::rotate( -M_PI / 2 );
-        mTextureFont->drawString( dbLabel, vec2( 0 ) );
-    gl::popModelView();
-    
+    // live readout, rounded to whole hertz so repeated values hit the glyph run cache
+    if( frame.mPitchLevel > mPipeline.getConfig()->mPitchThreshold ) {
+        string readout = to_string( (int)lround( frame.mPitchFreq ) ) + " Hz";
+        const Rectf &bounds = scene->mLayout.mPlotBounds;
+        gl::color( 0, 0.9f, 0.9f );
+        scene->mGlyphRuns.drawString( readout, vec2( bounds.x2 - scene->mGlyphRuns.measureString( readout ).x - 8, bounds.y1 + 20 ) );
+    }
+}
+
+void InputAnalyzer::drawTuner( WindowScene *scene, const AnalysisFrame &frame )
+{
+    const SceneLayout &layout = scene->mLayout;
+
+    // the cascade's estimate comes from the raw tap's latest samples, so the reading is as recent as the cheapest
+    // confident stage allows, independent of the FFT window
+    NoteReading reading;
+    if( frame.mEstimateConfidence > 0 )
+        reading = NoteReading( frame.mEstimateFreq, mPipeline.getConfig()->mTunerReference );
+
+    // cents meter: a bar from the center, green within 5 cents
+    ShapeBatch &shapes = scene->mShapeBatch;
+    const float meterWidth = layout.mWindowSize.x * 0.4f, meterY = layout.mCenter.y + 100 * layout.mShapeScale;
+    shapes.addRect( Rectf( layout.mCenter.x - meterWidth, meterY - 1, layout.mCenter.x + meterWidth, meterY + 1 ), ColorA( 1, 1, 1, 0.3f ) );
+    shapes.addRect( Rectf( layout.mCenter.x - 1, meterY - 20, layout.mCenter.x + 1, meterY + 20 ), ColorA( 1, 1, 1, 0.6f ) );
+    if( reading.isValid() ) {
+        float needleX = layout.mCenter.x + reading.mCents / 50 * meterWidth;
+        ColorA needleColor = fabs( reading.mCents ) < 5 ? ColorA( 0, 1, 0.4f ) : ColorA( 1, 0.55f, 0 );
+        shapes.addRect( Rectf( min( needleX, layout.mCenter.x ), meterY - 12, max( needleX, layout.mCenter.x ), meterY + 12 ), needleColor );
+    }
+    shapes.draw();
+
+    if( ! mTunerFont )
+        return;
+
+    // whole cents and the note's name repeat constantly, so both come straight from the glyph run cache
+    GlyphRunCache &runs = scene->mTunerGlyphRuns;
+    runs.setFont( mTunerFont );
+    string note = reading.isValid() ? reading.getName() + to_string( reading.getOctave() ) : "-";
+    gl::color( 1, 1, 1, reading.isValid() ? 1.0f : 0.3f );
+    {
+        gl::ScopedModelMatrix modelScope;
+        gl::translate( layout.mCenter.x - runs.measureString( note ).x / 2 * layout.mShapeScale, layout.mCenter.y );
+        gl::scale( vec2( layout.mShapeScale ) );
+        runs.drawString( note, vec2( 0 ) );
+    }
+
+    if( reading.isValid() ) {
+        int cents = (int)lround( reading.mCents );
+        string deviation = ( cents > 0 ? "+" : "" ) + to_string( cents );
+        float scale = layout.mShapeScale * 0.4f;
+        gl::ScopedModelMatrix modelScope;
+        gl::translate( layout.mCenter.x - runs.measureString( deviation ).x / 2 * scale, meterY + 90 * layout.mShapeScale );
+        gl::scale( vec2( scale ) );
+        runs.drawString( deviation, vec2( 0 ) );
+    }
 }
 
-void InputAnalyzer::printBinInfo( int mouseX )
+void InputAnalyzer::printBinInfo( WindowScene *scene, const AnalysisFrame &frame, int mouseX )
 {
-    size_t numBins = mMonitorSpectralNode->getFftSize() / 2;
-    size_t bin = std::min( numBins - 1, size_t( ( numBins * ( mouseX - mSpectrumPlot.getBounds().x1 ) ) / mSpectrumPlot.getBounds().getWidth() ) );
+    if( frame.mMagSpectrum.empty() )
+        return;
+
+    // Goes through the same column -> bin table the plot is drawn with, so it is correct for every scale. The plot's
+    // axis is only rebuilt when it is drawn, it is stale when the FFT size changed since (e.g. in tuner mode), so a
+    // copy is set up for this frame's bins; that does nothing when they match.
+    const SpectrumEnvelopePlot &plot = scene->mSpectrumPlot;
+    FrequencyAxis axis = plot.getAxis();
+    axis.setup( frame.mMagSpectrum.size(), (size_t)max( 1.0f, plot.getBounds().getWidth() ), frame.getNyquist(), plot.getScale() );
+    size_t bin = axis.getBinForColumn( mouseX - plot.getBounds().x1 );
 
-    float binFreqWidth = mMonitorSpectralNode->getFreqForBin( 1 ) - mMonitorSpectralNode->getFreqForBin( 0 );
-    float freq = mMonitorSpectralNode->getFreqForBin( bin );
-    float mag = audio::linearToDecibel( mMagSpectrum[bin] );
+    float binFreqWidth = frame.getFreqForBin( 1 ) - frame.getFreqForBin( 0 );
+    float freq = frame.getFreqForBin( (float)bin );
+    float mag = audio::linearToDecibel( frame.mMagSpectrum[bin] );
 
     console() << "bin: " << bin << ", freqency (hertz): " << freq << " - " << freq + binFreqWidth << ", magnitude (decibels): " << mag << endl;
 }
@@ -0,0 +1,157 @@
+#include "InputAnalyzerC.h"
+#include "BlockAnalyzer.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <exception>
+#include <string>
+
+using namespace ci;
+using namespace std;
+
+struct ia_analyzer {
+    ia_analyzer( float sampleRate, size_t hopSize ) : mAnalyzer( sampleRate, hopSize ) {}
+
+    BlockAnalyzer   mAnalyzer;
+    string          mLastError;
+};
+
+static_assert( (int)PitchEngine::Stage::YIN == IA_STAGE_YIN && (int)PitchEngine::Stage::CEPSTRAL == IA_STAGE_CEPSTRAL, "IA_STAGE_* are out of date" );
+
+namespace {
+
+// the smallest ia_result a host may pass, the one of API version 1; later versions only append fields
+const size_t kResultSizeV1 = offsetof( ia_result, cents ) + sizeof( float );
+
+// exceptions never cross the C boundary
+int32_t setConfig( ia_analyzer *analyzer, const AnalysisConfigRef &config )
+{
+    try {
+        analyzer->mAnalyzer.setConfig( config );
+        analyzer->mLastError.clear();
+        return IA_OK;
+    }
+    catch( std::exception &exc ) {
+        analyzer->mLastError = exc.what();
+        return IA_ERROR_INTERNAL;
+    }
+}
+
+} // anonymous namespace
+
+uint32_t ia_get_api_version( void )
+{
+    return IA_API_VERSION;
+}
+
+ia_analyzer* ia_create( float sample_rate, uint32_t hop_size )
+{
+    if( sample_rate <= 0 || hop_size == 0 )
+        return nullptr;
+
+    try {
+        return new ia_analyzer( sample_rate, hop_size );
+    }
+    catch( std::exception & ) {
+        return nullptr;
+    }
+}
+
+void ia_destroy( ia_analyzer *analyzer )
+{
+    delete analyzer;
+}
+
+int32_t ia_set_preset( ia_analyzer *analyzer, const char *name )
+{
+    if( ! analyzer || ! name )
+        return IA_ERROR_ARGUMENT;
+
+    const AnalysisConfig &current = *analyzer->mAnalyzer.getConfig();
+    auto presetIt = current.mPresets.find( name );
+    if( presetIt == current.mPresets.end() ) {
+        analyzer->mLastError = string( "unknown preset: " ) + name;
+        return IA_ERROR_CONFIG;
+    }
+
+    auto config = make_shared<AnalysisConfig>( current );
+    config->mPreset = name;
+    config->mAnalysis = presetIt->second;
+    return setConfig( analyzer, config );
+}
+
+int32_t ia_configure( ia_analyzer *analyzer, const char *json )
+{
+    if( ! analyzer || ! json )
+        return IA_ERROR_ARGUMENT;
+
+    AnalysisConfigRef config;
+    try {
+        config = AnalysisConfig::create( JsonTree( string( json ) ) );
+    }
+    catch( std::exception &exc ) {
+        analyzer->mLastError = exc.what();
+        return IA_ERROR_CONFIG;
+    }
+
+    return setConfig( analyzer, config );
+}
+
+const char* ia_get_last_error( const ia_analyzer *analyzer )
+{
+    return analyzer ? analyzer->mLastError.c_str() : "";
+}
+
+int32_t ia_process( ia_analyzer *analyzer, const float *block, size_t num_frames, ia_result *result )
+{
+    if( ! analyzer || ( ! block && num_frames ) || ( result && result->struct_size < kResultSizeV1 ) )
+        return IA_ERROR_ARGUMENT;
+
+    BlockAnalyzer &blockAnalyzer = analyzer->mAnalyzer;
+    if( ! blockAnalyzer.process( block, num_frames ) )
+        return IA_PENDING;
+
+    if( result ) {
+        const SpectralFeatures &features = blockAnalyzer.getFeatures();
+        const PitchEngine::Result &estimate = blockAnalyzer.getEstimate();
+        const NoteReading &note = blockAnalyzer.getNote();
+
+        ia_result current;
+        current.struct_size = result->struct_size;
+        current.analyzed_frames = blockAnalyzer.getAnalyzedFrames();
+        current.input_level = features.mInputLevel;
+        current.spectral_centroid = features.mSpectralCentroid;
+        current.pitch_freq = features.mPitchFreq;
+        current.pitch_level = features.mPitchLevel;
+        current.estimate_freq = estimate.mEstimate.mFreq;
+        current.estimate_confidence = estimate.mEstimate.mConfidence;
+        current.estimate_stage = (int32_t)estimate.mStage;
+        current.note = note.mNote;
+        current.cents = note.mCents;
+
+        // a host built against an older, smaller ia_result only gets the fields it knows about
+        memcpy( result, &current, min<size_t>( result->struct_size, sizeof( ia_result ) ) );
+    }
+
+    return IA_OK;
+}
+
+uint32_t ia_get_latency( const ia_analyzer *analyzer )
+{
+    return analyzer ? (uint32_t)analyzer->mAnalyzer.getLatency() : 0;
+}
+
+const float* ia_get_spectrum( const ia_analyzer *analyzer, size_t *num_bins )
+{
+    if( ! analyzer ) {
+        if( num_bins )
+            *num_bins = 0;
+        return nullptr;
+    }
+
+    const vector<float> &magSpectrum = analyzer->mAnalyzer.getMagSpectrum();
+    if( num_bins )
+        *num_bins = magSpectrum.size();
+    return magSpectrum.data();
+}
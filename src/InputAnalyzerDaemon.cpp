@@ -0,0 +1,141 @@
+/*
+Headless entry point for InputAnalyzer: builds the same audio graph and analysis as the app, but creates no
+window, renderer or GL context. Pitch events are sent to the console, OSC over UDP and / or shared memory.
+
+usage: InputAnalyzerDaemon [--quiet] [--osc host:port] [--shm name] [--config file.json] [--tune-buffer]
+*/
+
+#include "cinder/audio/audio.h"
+#include "AnalysisOutputs.h"
+#include "AnalysisPipeline.h"
+#include "BufferAutoTuner.h"
+#include "ConfigWatcher.h"
+#include "StartupMetrics.h"
+
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+using namespace ci;
+using namespace std;
+
+namespace {
+
+atomic<bool> sQuit( false );
+
+void handleSignal( int )
+{
+    sQuit = true;
+}
+
+void printUsage()
+{
+    printf( "usage: InputAnalyzerDaemon [--quiet] [--osc host:port] [--shm name] [--config file.json] [--tune-buffer]\n" );
+}
+
+} // anonymous namespace
+
+int main( int argc, char *argv[] )
+{
+    vector<AnalysisOutputPtr> outputs;
+    bool logEnabled = true;
+    ConfigWatcher configWatcher;
+    bool forceBufferProbe = false;
+
+    for( int i = 1; i < argc; i++ ) {
+        string arg = argv[i];
+        if( arg == "--quiet" )
+            logEnabled = false;
+        else if( arg == "--osc" && i + 1 < argc ) {
+            string dest = argv[++i];
+            size_t colon = dest.rfind( ':' );
+            if( colon == string::npos ) {
+                printUsage();
+                return 1;
+            }
+            outputs.emplace_back( new OscOutput( dest.substr( 0, colon ), (uint16_t)atoi( dest.c_str() + colon + 1 ) ) );
+        }
+        else if( arg == "--shm" && i + 1 < argc )
+            outputs.emplace_back( new SharedMemoryOutput( argv[++i] ) );
+        else if( arg == "--config" && i + 1 < argc )
+            configWatcher.start( argv[++i] );
+        else if( arg == "--tune-buffer" )
+            forceBufferProbe = true;
+        else {
+            printUsage();
+            return arg == "--help" ? 0 : 1;
+        }
+    }
+
+    LogOutput *log = nullptr;
+    if( logEnabled ) {
+        log = new LogOutput;
+        outputs.emplace_back( log );
+    }
+
+    signal( SIGINT, handleSignal );
+    signal( SIGTERM, handleSignal );
+
+    AnalysisPipeline pipeline;
+    pipeline.setup();
+    StartupMetrics::instance().mark( "audio_ready" );
+    printf( "analyzing input from: %s\n", pipeline.getInputDeviceNode()->getDevice()->getName().c_str() );
+
+    // the stored block size for this device, or a probe for the smallest stable one (always with --tune-buffer)
+    BufferAutoTuner bufferTuner;
+    bufferTuner.start( pipeline.getInputDeviceNode(), pipeline.getTimingNode(), forceBufferProbe );
+    auto startTime = chrono::steady_clock::now();
+
+    auto ctx = audio::master();
+    ThreadPolicy analysisThreadPolicy;
+    uint32_t inputRevision = pipeline.getInputRevision();
+    while( ! sQuit ) {
+        // built-in defaults without --config
+        pipeline.setConfig( configWatcher.getConfig() );
+        if( log )
+            log->setMinLevel( pipeline.getConfig()->mPitchThreshold );
+
+        // the worker owns the context and the input until the pipeline has swapped its result in
+        if( pipeline.isRebuilding() )
+            bufferTuner.suspend();
+        else {
+            if( pipeline.getInputRevision() != inputRevision ) {
+                inputRevision = pipeline.getInputRevision();
+                bufferTuner.setInput( pipeline.getInputDeviceNode() );
+                printf( "analyzing input from: %s\n", pipeline.getInputDeviceNode()->getDevice()->getName().c_str() );
+            }
+
+            bufferTuner.update( chrono::duration<double>( chrono::steady_clock::now() - startTime ).count() );
+        }
+
+        // this loop is the analysis thread, the audio thread's policy is applied by the pipeline
+        if( pipeline.getConfig()->mAnalysisThread != analysisThreadPolicy ) {
+            analysisThreadPolicy = pipeline.getConfig()->mAnalysisThread;
+            printf( "analysis thread: %s\n", applyThreadPolicy( analysisThreadPolicy ).describe().c_str() );
+        }
+
+        if( pipeline.update() ) {
+            const AnalysisFrame &frame = *pipeline.getFrame();
+            if( frame.mPitchLevel > pipeline.getConfig()->mPitchThreshold && ! StartupMetrics::instance().hasMark( "first_pitch" ) ) {
+                StartupMetrics::instance().mark( "first_pitch" );
+                printf( "%s\n", StartupMetrics::instance().format().c_str() );
+            }
+
+            for( auto &output : outputs )
+                output->send( frame );
+        }
+
+        // poll about twice per audio block, a new frame is published whenever the audio thread processed one;
+        // the block size changes while tuning. The context isn't read during a rebuild, that polls at the minimum.
+        double blockSeconds = pipeline.isRebuilding() ? 0 : (double)ctx->getFramesPerBlock() / (double)ctx->getSampleRate();
+        this_thread::sleep_for( chrono::microseconds( max<long long>( 1000, (long long)( blockSeconds * 0.5e6 ) ) ) );
+    }
+
+    ctx->disable();
+    printf( "pitch engine: %s\n", pipeline.getPitchEngine().getStats().format().c_str() );
+    return 0;
+}
@@ -0,0 +1,288 @@
+/*
+Query by humming over a corpus of recordings. "build" runs the block analysis (BlockAnalyzer) over every audio file on
+all cores and writes their melodies (PitchContour) to a memory-mapped ContourIndex; "query" analyzes a sung or hummed
+melody, from a file or the microphone, and prints the closest clips.
+
+usage: InputAnalyzerIndex build <index> <audio file or folder>... [--threads n] [--config file.json] [--preset name]
+       InputAnalyzerIndex query <index> (<audio file> | --mic seconds) [--results n] [--config file.json] [--preset name]
+*/
+
+#include "cinder/audio/audio.h"
+#include "BlockAnalyzer.h"
+#include "ContourIndex.h"
+#include "ParallelFor.h"
+#include "PitchContour.h"
+#include "RawSampleTap.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <thread>
+
+using namespace ci;
+using namespace std;
+
+namespace {
+
+const size_t kHopSize = 512;
+const char *kAudioExtensions[] = { ".wav", ".aif", ".aiff", ".caf", ".flac", ".mp3", ".m4a", ".ogg" };
+
+atomic<bool> sQuit( false );
+
+void handleSignal( int )
+{
+    sQuit = true;
+}
+
+void printUsage()
+{
+    printf( "usage: InputAnalyzerIndex build <index> <audio file or folder>... [--threads n] [--config file.json] [--preset name]\n"
+            "       InputAnalyzerIndex query <index> (<audio file> | --mic seconds) [--results n] [--config file.json] [--preset name]\n" );
+}
+
+//! The defaults without \a path. Throws AnalysisConfigExc, or ci::Exception if the file can't be read.
+AnalysisConfigRef loadConfig( const string &path, const string &preset )
+{
+    AnalysisConfigRef config = path.empty() ? make_shared<AnalysisConfig>() : AnalysisConfig::create( JsonTree( loadFile( path ) ) );
+    if( preset.empty() )
+        return config;
+
+    auto presetIt = config->mPresets.find( preset );
+    if( presetIt == config->mPresets.end() )
+        throw AnalysisConfigExc( "unknown preset: " + preset );
+
+    auto result = make_shared<AnalysisConfig>( *config );
+    result->mPreset = preset;
+    result->mAnalysis = presetIt->second;
+    return result;
+}
+
+bool isAudioFile( const fs::path &path )
+{
+    string extension = path.extension().string();
+    transform( extension.begin(), extension.end(), extension.begin(), []( char c ) { return (char)tolower( c ); } );
+    return find( begin( kAudioExtensions ), end( kAudioExtensions ), extension ) != end( kAudioExtensions );
+}
+
+//! Files as given, folders searched recursively for audio files, in a stable order so rebuilt indexes match.
+vector<fs::path> collectFiles( const vector<string> &args )
+{
+    vector<fs::path> result;
+    for( const auto &arg : args ) {
+        if( ! fs::is_directory( arg ) ) {
+            result.push_back( arg );
+            continue;
+        }
+
+        vector<fs::path> found;
+        for( fs::recursive_directory_iterator it( arg ), end; it != end; ++it ) {
+            if( fs::is_regular_file( it->path() ) && isAudioFile( it->path() ) )
+                found.push_back( it->path() );
+        }
+
+        sort( found.begin(), found.end() );
+        result.insert( result.end(), found.begin(), found.end() );
+    }
+
+    return result;
+}
+
+//! Melody of an audio file, mixed down to mono and analyzed at its own rate. Throws if it can't be decoded.
+vector<float> analyzeFile( const fs::path &path, const AnalysisConfigRef &config )
+{
+    audio::SourceFileRef source = audio::load( loadFile( path ) );
+    const size_t numChannels = source->getNumChannels();
+    BlockAnalyzer analyzer( (float)source->getSampleRate(), kHopSize, config );
+    PitchContour contour;
+
+    // read a hop at a time, there's no need to hold the whole file
+    audio::Buffer buffer( kHopSize, numChannels );
+    vector<float> mono( kHopSize );
+    for( size_t numFrames = source->read( &buffer ); numFrames; numFrames = source->read( &buffer ) ) {
+        for( size_t i = 0; i < numFrames; i++ ) {
+            float sum = 0;
+            for( size_t ch = 0; ch < numChannels; ch++ )
+                sum += buffer.getChannel( ch )[i];
+            mono[i] = sum / (float)numChannels;
+        }
+
+        if( analyzer.process( mono.data(), numFrames ) )
+            contour.addHop( analyzer.getEstimate().mEstimate );
+    }
+
+    contour.finish();
+    return contour.getIntervals();
+}
+
+//! Melody sung into the default input device over \a seconds, or until interrupted.
+vector<float> recordMelody( double seconds, const AnalysisConfigRef &config )
+{
+    auto ctx = audio::master();
+    auto inputDeviceNode = ctx->createInputDeviceNode();
+    auto tap = ctx->makeNode( new RawSampleTap( audio::Node::Format().autoEnable() ) );
+    // pulls the tap, nothing is played back
+    auto monitorNode = ctx->makeNode( new audio::MonitorNode );
+    inputDeviceNode >> tap >> monitorNode;
+    inputDeviceNode->enable();
+    ctx->enable();
+
+    BlockAnalyzer analyzer( (float)ctx->getSampleRate(), kHopSize, config );
+    PitchContour contour;
+    RawSampleTap::Reader reader = tap->createReader();
+    printf( "listening to %s for %g seconds, ctrl-c to stop early...\n", inputDeviceNode->getDevice()->getName().c_str(), seconds );
+
+    auto end = chrono::steady_clock::now() + chrono::duration<double>( seconds );
+    while( ! sQuit && chrono::steady_clock::now() < end ) {
+        for( const float *hop = reader.next( kHopSize, kHopSize ); hop; hop = reader.next( kHopSize, kHopSize ) ) {
+            if( analyzer.process( hop, kHopSize ) )
+                contour.addHop( analyzer.getEstimate().mEstimate );
+        }
+
+        this_thread::sleep_for( chrono::milliseconds( 5 ) );
+    }
+
+    ctx->disable();
+    contour.finish();
+    return contour.getIntervals();
+}
+
+int build( const fs::path &indexPath, const vector<fs::path> &files, const AnalysisConfigRef &config, size_t numThreads )
+{
+    if( files.empty() ) {
+        fprintf( stderr, "no audio files to index\n" );
+        return 1;
+    }
+
+    // a fresh analyzer per file
+    vector<vector<float>> contours( files.size() );
+    vector<char> analyzed( files.size(), 0 );
+    atomic<size_t> numDone( 0 );
+    mutex logMutex;
+    auto startTime = chrono::steady_clock::now();
+    parallelFor( files.size(), numThreads, [&]( size_t i ) {
+        try {
+            contours[i] = analyzeFile( files[i], config );
+            analyzed[i] = 1;
+        }
+        catch( std::exception &exc ) {
+            lock_guard<mutex> lock( logMutex );
+            fprintf( stderr, "skipping %s: %s\n", files[i].string().c_str(), exc.what() );
+        }
+
+        size_t done = ++numDone;
+        if( done % 100 == 0 ) {
+            lock_guard<mutex> lock( logMutex );
+            printf( "analyzed %zu / %zu files\n", done, files.size() );
+        }
+
+        return ! sQuit;
+    } );
+
+    if( sQuit ) {
+        fprintf( stderr, "interrupted, no index written\n" );
+        return 1;
+    }
+
+    ContourIndexWriter writer;
+    size_t numNotes = 0;
+    for( size_t i = 0; i < files.size(); i++ ) {
+        if( analyzed[i] ) {
+            writer.add( files[i].generic_string(), contours[i] );
+            numNotes += contours[i].size() + 1;
+        }
+    }
+
+    writer.write( indexPath );
+    printf( "indexed %zu of %zu files (%zu notes) into %s in %.1f seconds\n", writer.getNumClips(), files.size(), numNotes,
+            indexPath.string().c_str(), chrono::duration<double>( chrono::steady_clock::now() - startTime ).count() );
+    return 0;
+}
+
+int query( const ContourIndex &index, const vector<float> &intervals, size_t numResults )
+{
+    if( intervals.size() < ContourIndex::kGramLength ) {
+        fprintf( stderr, "heard %zu notes, a query needs at least %zu\n", intervals.empty() ? 0 : intervals.size() + 1, ContourIndex::kGramLength + 1 );
+        return 1;
+    }
+
+    ContourIndex::QueryOptions options;
+    options.mMaxResults = numResults;
+    auto startTime = chrono::steady_clock::now();
+    vector<ContourIndex::Match> matches = index.query( intervals, options );
+    double milliseconds = chrono::duration<double, milli>( chrono::steady_clock::now() - startTime ).count();
+
+    printf( "query: %zu notes, %zu matches over %zu clips in %.2f ms\n", intervals.size() + 1, matches.size(), index.getNumClips(), milliseconds );
+    for( size_t i = 0; i < matches.size(); i++ ) {
+        const ContourIndex::Match &match = matches[i];
+        printf( "%3zu. %6.3f  %s (from note %zu, %u n-grams)\n", i + 1, match.mDistance, match.mName.c_str(), match.mPosition, match.mVotes );
+    }
+
+    return 0;
+}
+
+} // anonymous namespace
+
+int main( int argc, char *argv[] )
+{
+    if( argc < 3 ) {
+        printUsage();
+        return argc == 2 && strcmp( argv[1], "--help" ) == 0 ? 0 : 1;
+    }
+
+    const string mode = argv[1];
+    const fs::path indexPath = argv[2];
+    vector<string> inputs;
+    string configPath, preset;
+    size_t numThreads = 0, numResults = 10;
+    double micSeconds = 0;
+
+    for( int i = 3; i < argc; i++ ) {
+        string arg = argv[i];
+        if( arg == "--threads" && i + 1 < argc )
+            numThreads = (size_t)atoi( argv[++i] );
+        else if( arg == "--results" && i + 1 < argc )
+            numResults = (size_t)max( 1, atoi( argv[++i] ) );
+        else if( arg == "--mic" && i + 1 < argc )
+            micSeconds = atof( argv[++i] );
+        else if( arg == "--config" && i + 1 < argc )
+            configPath = argv[++i];
+        else if( arg == "--preset" && i + 1 < argc )
+            preset = argv[++i];
+        else if( arg.compare( 0, 2, "--" ) != 0 )
+            inputs.push_back( arg );
+        else {
+            printUsage();
+            return 1;
+        }
+    }
+
+    const bool isQuery = mode == "query";
+    if( ( mode != "build" && ! isQuery ) || ( isQuery && ( micSeconds > 0 ? ! inputs.empty() : inputs.size() != 1 ) ) ) {
+        printUsage();
+        return 1;
+    }
+
+    signal( SIGINT, handleSignal );
+    signal( SIGTERM, handleSignal );
+
+    try {
+        AnalysisConfigRef config = loadConfig( configPath, preset );
+        if( ! isQuery )
+            return build( indexPath, collectFiles( inputs ), config, numThreads );
+
+        // opened first, a bad index shouldn't cost a recording
+        ContourIndex index( indexPath );
+        vector<float> intervals = micSeconds > 0 ? recordMelody( micSeconds, config ) : analyzeFile( inputs[0], config );
+        return query( index, intervals, numResults );
+    }
+    catch( std::exception &exc ) {
+        fprintf( stderr, "%s\n", exc.what() );
+        return 1;
+    }
+}
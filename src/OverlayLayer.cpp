@@ -0,0 +1,127 @@
+#include "OverlayLayer.h"
+#include "NoteTables.h"
+
+#include "cinder/gl/gl.h"
+
+#include <cmath>
+
+using namespace ci;
+using namespace std;
+
+namespace {
+
+string getGridLabel( const FrequencyAxis::GridLine &line )
+{
+    if( line.mMidiNote >= 0 )
+        return string( kNoteNames[getNotePitchClass( line.mMidiNote )] ) + to_string( getNoteOctave( line.mMidiNote ) );
+
+    if( line.mFreq >= 1000 )
+        return to_string( (int)lround( line.mFreq / 1000 ) ) + "k";
+
+    return to_string( (int)lround( line.mFreq ) );
+}
+
+bool isSameRect( const Rectf &a, const Rectf &b )
+{
+    return a.x1 == b.x1 && a.y1 == b.y1 && a.x2 == b.x2 && a.y2 == b.y2;
+}
+
+} // anonymous namespace
+
+OverlayLayer::OverlayLayer()
+    : mContentScale( 0 ), mAxisRevision( 0 ), mDirty( true )
+{
+}
+
+void OverlayLayer::setFont( const gl::TextureFontRef &font )
+{
+    if( font == mFont )
+        return;
+
+    mFont = font;
+    mDirty = true;
+}
+
+void OverlayLayer::draw( const ivec2 &windowSize, float contentScale, const Rectf &plotBounds, const FrequencyAxis &axis )
+{
+    if( windowSize.x <= 0 || windowSize.y <= 0 || ! mFont )
+        return;
+
+    if( windowSize.x != mWindowSize.x || windowSize.y != mWindowSize.y || contentScale != mContentScale ) {
+        ivec2 pixelSize( (int)ceil( windowSize.x * contentScale ), (int)ceil( windowSize.y * contentScale ) );
+        mFbo = gl::Fbo::create( pixelSize.x, pixelSize.y, gl::Fbo::Format().disableDepth() );
+        mDirty = true;
+    }
+
+    if( ! isSameRect( plotBounds, mPlotBounds ) || axis.getRevision() != mAxisRevision )
+        mDirty = true;
+
+    mWindowSize = windowSize;
+    mContentScale = contentScale;
+    mPlotBounds = plotBounds;
+    mAxisRevision = axis.getRevision();
+
+    if( mDirty ) {
+        render( plotBounds, axis );
+        mDirty = false;
+    }
+
+    // the layer holds premultiplied color, see render()
+    gl::ScopedBlendPremult blendScope;
+    gl::ScopedColor colorScope( 1, 1, 1, 1 );
+    gl::draw( mFbo->getColorTexture(), Rectf( 0, 0, (float)windowSize.x, (float)windowSize.y ) );
+}
+
+void OverlayLayer::render( const Rectf &plotBounds, const FrequencyAxis &axis )
+{
+    gl::ScopedFramebuffer fboScope( mFbo );
+    gl::ScopedViewport viewportScope( ivec2( 0 ), mFbo->getSize() );
+    gl::ScopedMatrices matricesScope;
+    gl::setMatricesWindow( mWindowSize );
+    gl::clear( ColorA( 0, 0, 0, 0 ) );
+
+    // straight alpha for color, accumulate coverage in alpha, which leaves the Fbo premultiplied
+    gl::ScopedBlend blendScope( GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA );
+
+    const auto textOptions = gl::TextureFont::DrawOptions().scale( 1 / mContentScale ).pixelSnap( false );
+    const vec2 windowCenter( mWindowSize.x / 2.0f, mWindowSize.y / 2.0f );
+
+    // grid lines, labelled at the major ones
+    gl::VertBatch grid( GL_LINES );
+    for( const auto &line : axis.getGridLines() ) {
+        float x = plotBounds.x1 + line.mColumn;
+        grid.color( 1, 1, 1, line.mMajor ? 0.25f : 0.08f );
+        grid.vertex( vec2( x, plotBounds.y1 ) );
+        grid.vertex( vec2( x, plotBounds.y2 ) );
+    }
+    grid.draw();
+
+    gl::color( 0.6f, 0.6f, 0.6f );
+    for( const auto &line : axis.getGridLines() ) {
+        if( ! line.mMajor )
+            continue;
+
+        string label = getGridLabel( line );
+        float width = mFont->measureString( label, textOptions ).x;
+        mFont->drawString( label, vec2( plotBounds.x1 + line.mColumn - width / 2, plotBounds.y2 + 14 ), textOptions );
+    }
+
+    gl::color( 0, 0.9f, 0.9f );
+
+    // draw x-axis label
+    string freqLabel = "Frequency (hertz)";
+    if( axis.getScale() == FrequencyAxis::Scale::LOG )
+        freqLabel = "Frequency (hertz, log)";
+    else if( axis.getScale() == FrequencyAxis::Scale::NOTES )
+        freqLabel = "Frequency (notes)";
+
+    mFont->drawString( freqLabel, vec2( windowCenter.x - mFont->measureString( freqLabel, textOptions ).x / 2, (float)mWindowSize.y - 20 ), textOptions );
+
+    // draw y-axis label
+    string dbLabel = "Magnitude (decibels, linear)";
+    gl::pushModelView();
+        gl::translate( 30, windowCenter.y + mFont->measureString( dbLabel, textOptions ).x / 2 );
+        gl::rotate( -M_PI / 2 );
+        mFont->drawString( dbLabel, vec2( 0 ), textOptions );
+    gl::popModelView();
+}
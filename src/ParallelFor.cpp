@@ -0,0 +1,48 @@
+#include "ParallelFor.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+void parallelFor( size_t numItems, size_t numThreads, const function<bool( size_t )> &work )
+{
+    if( ! numThreads )
+        numThreads = max<size_t>( 1, thread::hardware_concurrency() );
+    numThreads = min( numThreads, max<size_t>( 1, numItems ) );
+
+    atomic<size_t> nextItem( 0 );
+    atomic<bool> stopped( false ), failed( false );
+    exception_ptr error;
+    auto worker = [&] {
+        try {
+            for( size_t i = nextItem++; i < numItems && ! stopped; i = nextItem++ ) {
+                if( ! work( i ) )
+                    stopped = true;
+            }
+        }
+        catch( ... ) {
+            stopped = true;
+            if( ! failed.exchange( true ) )
+                error = current_exception();
+        }
+    };
+
+    vector<thread> threads;
+    try {
+        for( size_t i = 1; i < numThreads; i++ )
+            threads.emplace_back( worker );
+    }
+    catch( system_error & ) {
+    }
+    worker();
+    for( auto &thread : threads )
+        thread.join();
+
+    if( error )
+        rethrow_exception( error );
+}
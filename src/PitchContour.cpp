@@ -0,0 +1,66 @@
+#include "PitchContour.h"
+#include "NoteTables.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+PitchContour::PitchContour( const Options &options )
+    : mOptions( options ), mNoteSum( 0 ), mGapHops( 0 )
+{
+}
+
+void PitchContour::addHop( const PitchEstimate &estimate )
+{
+    if( ! estimate.isVoiced() || estimate.mConfidence < mOptions.mMinConfidence ) {
+        if( ++mGapHops > mOptions.mMaxGapHops )
+            endNote();
+        return;
+    }
+
+    // the reference cancels out of the intervals
+    float pitch = freqToNote( estimate.mFreq );
+    if( ! mNoteHops.empty() && fabs( pitch - mNoteSum / (float)mNoteHops.size() ) > mOptions.mNoteTolerance )
+        endNote();
+
+    mGapHops = 0;
+    mNoteHops.push_back( pitch );
+    mNoteSum += pitch;
+}
+
+void PitchContour::finish()
+{
+    endNote();
+}
+
+void PitchContour::clear()
+{
+    mNotes.clear();
+    mNoteHops.clear();
+    mNoteSum = 0;
+    mGapHops = 0;
+}
+
+vector<float> PitchContour::getIntervals() const
+{
+    vector<float> result;
+    for( size_t i = 1; i < mNotes.size(); i++ )
+        result.push_back( mNotes[i] - mNotes[i - 1] );
+
+    return result;
+}
+
+void PitchContour::endNote()
+{
+    // the median ignores the onset and release, where the pitch is still gliding
+    if( mNoteHops.size() >= max<size_t>( 1, mOptions.mMinNoteHops ) ) {
+        auto middle = mNoteHops.begin() + mNoteHops.size() / 2;
+        nth_element( mNoteHops.begin(), middle, mNoteHops.end() );
+        mNotes.push_back( *middle );
+    }
+
+    mNoteHops.clear();
+    mNoteSum = 0;
+    mGapHops = 0;
+}
@@ -0,0 +1,247 @@
+#include "PitchEngine.h"
+
+#include "cinder/CinderAssert.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+
+using namespace std;
+
+namespace {
+
+typedef chrono::steady_clock Clock;
+
+double secondsSince( Clock::time_point start )
+{
+    return chrono::duration<double>( Clock::now() - start ).count();
+}
+
+} // anonymous namespace
+
+PitchEngine::Stats::Stats()
+    : mNumFrames( 0 )
+{
+    fill( begin( mNumResolved ), end( mNumResolved ), 0 );
+    fill( begin( mNumRuns ), end( mNumRuns ), 0 );
+    fill( begin( mSeconds ), end( mSeconds ), 0.0 );
+}
+
+string PitchEngine::Stats::format() const
+{
+    if( ! mNumFrames )
+        return "no frames";
+
+    string result = to_string( mNumFrames ) + " frames -";
+    double totalSeconds = 0;
+    for( size_t i = 0; i < (size_t)Stage::NUM_STAGES; i++ ) {
+        char part[64];
+        snprintf( part, sizeof( part ), "%s %s %.0f%%", i ? "," : "", getStageName( (Stage)i ), 100.0 * mNumResolved[i] / mNumFrames );
+        result += part;
+        totalSeconds += mSeconds[i];
+    }
+
+    // what the cascade costs per frame, against what YIN costs whenever it runs
+    size_t yin = (size_t)Stage::YIN;
+    char cost[96];
+    snprintf( cost, sizeof( cost ), " - %.1f us/frame, yin alone %.1f us", totalSeconds * 1e6 / mNumFrames,
+                mNumRuns[yin] ? mSeconds[yin] * 1e6 / mNumRuns[yin] : 0.0 );
+    return result + cost;
+}
+
+PitchEngine::PitchEngine( const Options &options )
+    : mOptions( options ), mYin( options.mYinThreshold ), mLastRms( 0 )
+{
+}
+
+void PitchEngine::setOptions( const Options &options )
+{
+    mOptions = options;
+    mYin.setThreshold( options.mYinThreshold );
+}
+
+void PitchEngine::reserve( size_t maxLag, size_t numBins )
+{
+    mYin.reserve( maxLag );
+    mHps.reserve( numBins );
+    mCepstrum.reserve( numBins * 2 );
+}
+
+const char* PitchEngine::getStageName( Stage stage )
+{
+    switch( stage ) {
+        case Stage::SILENT:         return "silent";
+        case Stage::ZERO_CROSSING:  return "zero crossing";
+        case Stage::SPECTRAL:       return "spectral";
+        case Stage::CEPSTRAL:       return "cepstral";
+        case Stage::YIN:            return "yin";
+        default:                    return "";
+    }
+}
+
+PitchEngine::Result PitchEngine::process( const float *raw, size_t numRaw, float rawRate, size_t minLag, size_t maxLag,
+                                          const float *magSpectrum, size_t numBins, float binWidth, size_t windowSize, ci::audio::dsp::Fft *fft )
+{
+    Result result;
+    mStats.mNumFrames++;
+
+    // stage 1, every frame: energy, onset and the zero-crossing rate over the last two longest periods
+    auto start = Clock::now();
+    size_t numRecent = min( numRaw, maxLag * 2 );
+    const float *recent = raw + numRaw - numRecent;
+    float sumSquares = 0;
+    for( size_t i = 0; i < numRecent; i++ )
+        sumSquares += recent[i] * recent[i];
+    float rms = numRecent ? sqrt( sumSquares / (float)numRecent ) : 0;
+
+    result.mOnset = rms > mLastRms * mOptions.mOnsetRatio && rms > mOptions.mSilenceLevel;
+    mLastRms = rms;
+
+    size_t stage = (size_t)Stage::ZERO_CROSSING;
+    mStats.mNumRuns[stage]++;
+    if( rms < mOptions.mSilenceLevel ) {
+        mStats.mSeconds[stage] += secondsSince( start );
+        mStats.mNumResolved[(size_t)Stage::SILENT]++;
+        return result;
+    }
+
+    bool resolved = zeroCrossing( recent, numRecent, rawRate, minLag, maxLag, &result.mEstimate ) && ! result.mOnset;
+    mStats.mSeconds[stage] += secondsSince( start );
+    if( resolved ) {
+        result.mStage = Stage::ZERO_CROSSING;
+        mStats.mNumResolved[stage]++;
+        return result;
+    }
+
+    // stage 2, when the waveform is too complex for crossings: harmonic product spectrum
+    start = Clock::now();
+    stage = (size_t)Stage::SPECTRAL;
+    mStats.mNumRuns[stage]++;
+    float minFreq = rawRate / (float)maxLag, maxFreq = rawRate / (float)minLag;
+    resolved = harmonicProduct( magSpectrum, numBins, binWidth, minFreq, maxFreq, &result.mEstimate ) && ! result.mOnset;
+    mStats.mSeconds[stage] += secondsSince( start );
+    if( resolved ) {
+        result.mStage = Stage::SPECTRAL;
+        mStats.mNumResolved[stage]++;
+        return result;
+    }
+
+    // stage 3, for harmonics too far apart or too weak at the bottom for the product: the cepstrum, through the same plan
+    if( fft && ! result.mOnset ) {
+        start = Clock::now();
+        stage = (size_t)Stage::CEPSTRAL;
+        mStats.mNumRuns[stage]++;
+        PitchEstimate cepstral = mCepstrum.estimate( magSpectrum, numBins, windowSize, binWidth * (float)( numBins * 2 ), minFreq, maxFreq, fft );
+        mStats.mSeconds[stage] += secondsSince( start );
+        if( cepstral.mConfidence >= mOptions.mCepstrumMinConfidence ) {
+            result.mEstimate = cepstral;
+            result.mStage = Stage::CEPSTRAL;
+            mStats.mNumResolved[stage]++;
+            return result;
+        }
+    }
+
+    // stage 4, low confidence or an onset: YIN with parabolic refinement
+    start = Clock::now();
+    stage = (size_t)Stage::YIN;
+    mStats.mNumRuns[stage]++;
+    result.mEstimate = mYin.estimate( raw, numRaw, rawRate, minLag, maxLag );
+    result.mStage = Stage::YIN;
+    mStats.mSeconds[stage] += secondsSince( start );
+    mStats.mNumResolved[stage]++;
+    return result;
+}
+
+bool PitchEngine::zeroCrossing( const float *raw, size_t numRaw, float rawRate, size_t minLag, size_t maxLag, PitchEstimate *estimate ) const
+{
+    // upward crossings with a little hysteresis so noise around zero doesn't add any, interpolated between frames
+    float sumSquares = 0;
+    for( size_t i = 0; i < numRaw; i++ )
+        sumSquares += raw[i] * raw[i];
+    const float hysteresis = 0.1f * sqrt( sumSquares / (float)numRaw );
+
+    float crossings[64];
+    size_t numCrossings = 0;
+    bool armed = false;
+    for( size_t i = 1; i < numRaw && numCrossings < 64; i++ ) {
+        if( raw[i] < -hysteresis )
+            armed = true;
+        else if( armed && raw[i - 1] < 0 && raw[i] >= 0 ) {
+            crossings[numCrossings++] = (float)( i - 1 ) + raw[i - 1] / ( raw[i - 1] - raw[i] );
+            armed = false;
+        }
+    }
+
+    if( numCrossings < 4 )
+        return false;
+
+    // a single crossing per period leaves evenly spaced intervals, extra crossings from harmonics don't
+    float mean = ( crossings[numCrossings - 1] - crossings[0] ) / (float)( numCrossings - 1 );
+    float maxDeviation = 0;
+    for( size_t i = 1; i < numCrossings; i++ )
+        maxDeviation = max( maxDeviation, fabs( crossings[i] - crossings[i - 1] - mean ) );
+    maxDeviation /= mean;
+
+    if( maxDeviation > mOptions.mZeroCrossingMaxDeviation || mean < (float)minLag || mean > (float)maxLag )
+        return false;
+
+    *estimate = PitchEstimate( rawRate / mean, 1 - maxDeviation / mOptions.mZeroCrossingMaxDeviation );
+    return true;
+}
+
+bool PitchEngine::harmonicProduct( const float *magSpectrum, size_t numBins, float binWidth, float minFreq, float maxFreq, PitchEstimate *estimate )
+{
+    size_t first = max<size_t>( 1, (size_t)ceil( minFreq / binWidth ) );
+    size_t last = min( (size_t)( maxFreq / binWidth ), ( numBins - 1 ) / mOptions.mHpsHarmonics );
+    if( ! magSpectrum || last <= first + 2 )
+        return false;
+
+    // the top harmonic of the last bin has to stay inside the spectrum, last is capped for it
+    CI_ASSERT( last * mOptions.mHpsHarmonics < numBins );
+
+    // sum of logs rather than the product, the magnitudes are tiny
+    mHps.assign( last + 1, 0.0f );
+    size_t best = first;
+    for( size_t k = first; k <= last; k++ ) {
+        float sum = 0;
+        for( size_t h = 1; h <= mOptions.mHpsHarmonics; h++ )
+            sum += log( magSpectrum[k * h] + 1e-12f );
+        mHps[k] = sum;
+        if( sum > mHps[best] )
+            best = k;
+    }
+
+    // confidence from the margin over the strongest competitor outside the peak
+    float second = -numeric_limits<float>::infinity();
+    for( size_t k = first; k <= last; k++ ) {
+        if( k + 2 < best || k > best + 2 )
+            second = max( second, mHps[k] );
+    }
+
+    // per harmonic, so it reads as a magnitude ratio: 1 - 1 / 3 for a peak three times its competitor
+    float confidence = 1 - exp( ( second - mHps[best] ) / (float)mOptions.mHpsHarmonics );
+    if( confidence < mOptions.mHpsMinConfidence || best < mOptions.mHpsMinBin )
+        return false;
+
+    // the top harmonic's peak divided down is several times finer than the fundamental's bin
+    const size_t harmonics = mOptions.mHpsHarmonics;
+    size_t peak = best * harmonics;
+    for( size_t k = ( best - 1 ) * harmonics; k <= ( best + 1 ) * harmonics && k + 1 < numBins; k++ ) {
+        if( magSpectrum[k] > magSpectrum[peak] )
+            peak = k;
+    }
+
+    float bin = (float)peak;
+    if( peak > 0 && peak + 1 < numBins ) {
+        float prev = log( magSpectrum[peak - 1] + 1e-12f ), current = log( magSpectrum[peak] + 1e-12f ), next = log( magSpectrum[peak + 1] + 1e-12f );
+        float denominator = prev - 2 * current + next;
+        if( denominator < 0 )
+            bin += 0.5f * ( prev - next ) / denominator;
+    }
+    bin /= (float)harmonics;
+
+    *estimate = PitchEstimate( bin * binWidth, confidence );
+    return true;
+}
@@ -0,0 +1,70 @@
+#include "RateTables.h"
+#include "NoteTables.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+RateTables::RateTables( float sampleRate, float deviceRate, size_t fftSize, const AnalysisConfig &config )
+    : mSampleRate( sampleRate ), mDeviceRate( deviceRate ), mNyquist( sampleRate / 2 ), mFftSize( fftSize ), mNumBins( fftSize / 2 ),
+        mBinWidth( sampleRate / (float)fftSize ), mCentroidDivisor( sampleRate / config.mCentroidFactor )
+{
+    mBinFreqs.resize( mNumBins );
+    for( size_t i = 0; i < mNumBins; i++ )
+        mBinFreqs[i] = (float)i * mBinWidth;
+
+    const int numSteps = 128 * kStepsPerNote;
+    mHarmonicBins.resize( numSteps * kNumHarmonics * 2 );
+    for( int step = 0; step < numSteps; step++ ) {
+        float bin = getBinForFreq( noteToFreq( (float)step / kStepsPerNote ) );
+        for( size_t k = 0; k < kNumHarmonics * 2; k++ ) {
+            float multiple = bin * (float)( k + 1 ) / 2;
+            mHarmonicBins[step * kNumHarmonics * 2 + k] = multiple + 0.5f < (float)mNumBins ? (uint32_t)( multiple + 0.5f ) : (uint32_t)mNumBins;
+        }
+    }
+
+    // the time-domain estimators read the raw tap, resampled to the analysis rate like the spectrum's input
+    mMinLag = max<size_t>( 2, (size_t)floor( sampleRate / config.mMaxPitch ) );
+    mMaxLag = max( mMinLag + 1, (size_t)ceil( sampleRate / config.mMinPitch ) );
+}
+
+float RateTables::correctOctave( const float *magSpectrum, float freq ) const
+{
+    if( freq <= 0 )
+        return freq;
+
+    // harmonics minus the gaps halfway between them, each weighted by 1 / multiple: a subharmonic of the true pitch
+    // finds every other harmonic at half the weight, an octave above it scores the even harmonics minus the odd ones
+    auto score = [this, magSpectrum]( int step ) {
+        const uint32_t *bins = &mHarmonicBins[step * kNumHarmonics * 2];
+        float result = 0;
+        for( size_t k = 0; k < kNumHarmonics * 2; k++ ) {
+            if( bins[k] < mNumBins ) {
+                float weighted = magSpectrum[bins[k]] * 2 / (float)( k + 1 );
+                result += ( k & 1 ) ? weighted : -weighted;
+            }
+        }
+        return result;
+    };
+
+    const int numSteps = 128 * kStepsPerNote;
+    const int octave = 12 * kStepsPerNote;
+    int step = (int)lround( freqToNote( freq ) * kStepsPerNote );
+    if( step < 0 || step >= numSteps )
+        return freq;
+
+    float best = score( step );
+    float result = freq;
+    if( step - octave >= 0 ) {
+        float below = score( step - octave );
+        if( below > best ) {
+            best = below;
+            result = freq / 2;
+        }
+    }
+    if( step + octave < numSteps && score( step + octave ) > best )
+        result = freq * 2;
+
+    return result;
+}
@@ -0,0 +1,88 @@
+#include "RawSampleTap.h"
+
+#include <algorithm>
+
+using namespace ci;
+using namespace std;
+
+RawSampleTap::RawSampleTap( const Format &format, size_t capacity )
+    : Node( format ), mCapacity( 1 ), mWritePosition( 0 )
+{
+    while( mCapacity < capacity )
+        mCapacity *= 2;
+
+    // 8 extra floats to align the start to 32 bytes, for SIMD loads in the estimators
+    mStorage.reset( new float[mCapacity * 2 + 8] );
+    fill( mStorage.get(), mStorage.get() + mCapacity * 2 + 8, 0.0f );
+    uintptr_t address = reinterpret_cast<uintptr_t>( mStorage.get() );
+    mData = mStorage.get() + ( ( 32 - address % 32 ) % 32 ) / sizeof( float );
+}
+
+void RawSampleTap::process( audio::Buffer *buffer )
+{
+    // the buffer passes through untouched
+    const size_t numFrames = buffer->getNumFrames();
+    const size_t numChannels = buffer->getNumChannels();
+    const float channelScale = 1.0f / (float)max<size_t>( 1, numChannels );
+    const size_t mask = mCapacity - 1;
+    uint64_t position = mWritePosition.load( memory_order_relaxed );
+
+    for( size_t i = 0; i < numFrames; i++ ) {
+        float sample = 0;
+        for( size_t ch = 0; ch < numChannels; ch++ )
+            sample += buffer->getChannel( ch )[i];
+        sample *= channelScale;
+
+        size_t index = ( position + i ) & mask;
+        mData[index] = sample;
+        mData[index + mCapacity] = sample;
+    }
+
+    mWritePosition.store( position + numFrames, memory_order_release );
+}
+
+size_t RawSampleTap::getGuard() const
+{
+    return max<size_t>( getFramesPerBlock(), 1024 );
+}
+
+const float* RawSampleTap::Reader::next( size_t windowSize, size_t hop )
+{
+    if( ! mTap || windowSize + mTap->getGuard() > mTap->mCapacity )
+        return nullptr;
+
+    uint64_t writePosition = mTap->getWritePosition();
+    if( writePosition > mCursor && writePosition - mCursor > mTap->mCapacity - mTap->getGuard() - windowSize ) {
+        // fell too far behind, whatever was skipped is gone
+        uint64_t resumed = writePosition - windowSize;
+        mNumDropped += resumed - mCursor;
+        mCursor = resumed;
+    }
+
+    if( mCursor + windowSize > writePosition )
+        return nullptr;
+
+    mWindowStart = mCursor;
+    mCursor += hop;
+    return mTap->getFrames( mWindowStart );
+}
+
+const float* RawSampleTap::Reader::latest( size_t windowSize )
+{
+    if( ! mTap || windowSize + mTap->getGuard() > mTap->mCapacity )
+        return nullptr;
+
+    uint64_t writePosition = mTap->getWritePosition();
+    if( writePosition < windowSize )
+        return nullptr;
+
+    mWindowStart = writePosition - windowSize;
+    mCursor = writePosition;
+    return mTap->getFrames( mWindowStart );
+}
+
+bool RawSampleTap::Reader::isValid() const
+{
+    // the frame at mWindowStart is rewritten once the writer reaches mWindowStart + capacity
+    return mTap && mTap->getWritePosition() + mTap->getGuard() <= mWindowStart + mTap->mCapacity;
+}
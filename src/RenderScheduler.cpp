@@ -0,0 +1,34 @@
+#include "RenderScheduler.h"
+
+#include <algorithm>
+
+RenderScheduler::RenderScheduler( Mode mode, const Options &options )
+    : mMode( mode ), mOptions( options ), mCurrentTime( 0 ), mLastSignalTime( 0 ), mAnimationEndTime( 0 ), mIdle( false )
+{
+}
+
+void RenderScheduler::update( double currentTime, bool newAnalysisFrame, float inputLevel )
+{
+    mCurrentTime = currentTime;
+
+    if( newAnalysisFrame && inputLevel > mOptions.mSilenceThreshold )
+        mLastSignalTime = currentTime;
+
+    bool signalActive = currentTime - mLastSignalTime < mOptions.mSilenceHold;
+    bool animating = currentTime < mAnimationEndTime;
+    mIdle = ! signalActive && ! animating;
+}
+
+void RenderScheduler::requestAnimation( double seconds )
+{
+    mAnimationEndTime = std::max( mAnimationEndTime, mCurrentTime + seconds );
+    mIdle = false;
+}
+
+float RenderScheduler::getTargetFrameRate() const
+{
+    if( mMode == Mode::CONTINUOUS || ! mIdle )
+        return mOptions.mMaxFrameRate;
+
+    return std::min( mOptions.mIdleFrameRate, mOptions.mMaxFrameRate );
+}
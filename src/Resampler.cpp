@@ -0,0 +1,139 @@
+#include "Resampler.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+namespace {
+
+const double kPi = 3.14159265358979323846;
+const double kKaiserBeta = 8.6; // ~ -90 dB stopband
+
+// zeroth order modified Bessel function of the first kind, for the Kaiser window
+double besselI0( double x )
+{
+    double sum = 1, term = 1;
+    for( int k = 1; k < 32; k++ ) {
+        term *= ( x / ( 2 * k ) ) * ( x / ( 2 * k ) );
+        sum += term;
+        if( term < sum * 1e-12 )
+            break;
+    }
+
+    return sum;
+}
+
+// four accumulators so the loop vectorizes without reassociation flags
+float dot( const float *a, const float *b, size_t n )
+{
+    float s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+    size_t i = 0;
+    for( ; i + 4 <= n; i += 4 ) {
+        s0 += a[i] * b[i];
+        s1 += a[i + 1] * b[i + 1];
+        s2 += a[i + 2] * b[i + 2];
+        s3 += a[i + 3] * b[i + 3];
+    }
+    for( ; i < n; i++ )
+        s0 += a[i] * b[i];
+
+    return ( s0 + s1 ) + ( s2 + s3 );
+}
+
+} // anonymous namespace
+
+Resampler::Resampler( size_t zeroCrossings, size_t numPhases )
+    : mZeroCrossings( zeroCrossings ), mNumPhases( numPhases ), mSourceRate( 0 ), mTargetRate( 0 ), mNumTaps( 0 )
+{
+}
+
+void Resampler::setRates( float sourceRate, float targetRate )
+{
+    if( sourceRate == mSourceRate && targetRate == mTargetRate )
+        return;
+
+    mSourceRate = sourceRate;
+    mTargetRate = targetRate;
+    if( isBypassed() ) {
+        mTable.clear();
+        mNumTaps = 0;
+        return;
+    }
+
+    // when downsampling the sinc is stretched to the target's nyquist, which takes proportionally more source taps
+    double scale = min( 1.0, (double)targetRate / (double)sourceRate );
+    double cutoff = 0.5 * scale * 0.92; // cycles per source frame, leaves a transition band below nyquist
+    size_t halfTaps = (size_t)ceil( mZeroCrossings / scale );
+    mNumTaps = halfTaps * 2;
+
+    // row p holds the kernel for a read position p / mNumPhases past a source frame, one extra row for p == mNumPhases
+    mTable.assign( ( mNumPhases + 1 ) * mNumTaps, 0.0f );
+    const double i0Beta = besselI0( kKaiserBeta );
+    for( size_t p = 0; p <= mNumPhases; p++ ) {
+        float *row = &mTable[p * mNumTaps];
+        double frac = (double)p / (double)mNumPhases;
+        double sum = 0;
+        for( size_t k = 0; k < mNumTaps; k++ ) {
+            double x = (double)k - (double)halfTaps + 1 - frac;
+            double r = x / (double)halfTaps;
+            double window = fabs( r ) < 1 ? besselI0( kKaiserBeta * sqrt( 1 - r * r ) ) / i0Beta : 0;
+            double arg = 2 * kPi * cutoff * x;
+            double sinc = fabs( arg ) < 1e-9 ? 1 : sin( arg ) / arg;
+            double h = 2 * cutoff * sinc * window;
+            row[k] = (float)h;
+            sum += h;
+        }
+
+        // unity gain at DC for every phase, otherwise the sub-sample position shows up as ripple
+        for( size_t k = 0; k < mNumTaps; k++ )
+            row[k] = (float)( row[k] / sum );
+    }
+}
+
+size_t Resampler::getNumOutputFrames( size_t numSourceFrames ) const
+{
+    if( isBypassed() )
+        return numSourceFrames;
+    if( numSourceFrames <= mNumTaps )
+        return 0;
+
+    return (size_t)( (double)( numSourceFrames - mNumTaps ) * mTargetRate / mSourceRate ) + 1;
+}
+
+size_t Resampler::getNumSourceFrames( size_t numOutputFrames ) const
+{
+    if( isBypassed() || ! numOutputFrames )
+        return numOutputFrames;
+
+    return mNumTaps + 1 + (size_t)ceil( (double)( numOutputFrames - 1 ) * mSourceRate / mTargetRate );
+}
+
+void Resampler::processTail( const float *source, size_t numSourceFrames, float *dest, size_t numDestFrames ) const
+{
+    if( isBypassed() ) {
+        size_t numFrames = min( numSourceFrames, numDestFrames );
+        fill( dest, dest + numDestFrames - numFrames, 0.0f );
+        copy( source + numSourceFrames - numFrames, source + numSourceFrames, dest + numDestFrames - numFrames );
+        return;
+    }
+
+    const size_t halfTaps = mNumTaps / 2;
+    const double step = (double)mSourceRate / (double)mTargetRate;
+    const double lastPos = (double)numSourceFrames - 1 - (double)halfTaps;
+
+    for( size_t j = 0; j < numDestFrames; j++ ) {
+        double pos = lastPos - (double)( numDestFrames - 1 - j ) * step;
+        double base = floor( pos );
+        size_t phase = (size_t)lround( ( pos - base ) * (double)mNumPhases );
+
+        // taps start halfTaps - 1 frames before the read position
+        long first = (long)base - (long)halfTaps + 1;
+        if( first < 0 ) {
+            dest[j] = 0;
+            continue;
+        }
+
+        dest[j] = dot( &mTable[phase * mNumTaps], source + first, mNumTaps );
+    }
+}
@@ -0,0 +1,36 @@
+#include "SceneLayout.h"
+
+#include <algorithm>
+
+using namespace ci;
+
+namespace {
+
+const float sPlotMargin = 40;
+const vec2  sReferenceSize( 1024, 768 );
+
+} // anonymous namespace
+
+SceneLayout::SceneLayout()
+    : SceneLayout( ivec2( sReferenceSize.x, sReferenceSize.y ) )
+{
+}
+
+SceneLayout::SceneLayout( const ivec2 &windowSize )
+{
+    mWindowSize = vec2( (float)windowSize.x, (float)windowSize.y );
+    mCenter = mWindowSize / 2.0f;
+    mShapeScale = std::min( mWindowSize.x / sReferenceSize.x, mWindowSize.y / sReferenceSize.y );
+
+    float margin = sPlotMargin * mShapeScale;
+    mPlotBounds = Rectf( margin, margin, std::max( margin, mWindowSize.x - margin ), std::max( margin, mWindowSize.y - margin ) );
+    mPlotDecibelScale = mPlotBounds.getHeight() / 100;
+
+    mLowBandPos = vec2( mCenter.x * 0.5f, mCenter.y * 0.5f );
+    mMidBandPos = vec2( mCenter.x, mCenter.y * 0.5f );
+    mHighBandPos = vec2( mCenter.x * 1.5f, mCenter.y * 0.5f );
+
+    mCentroidPos = mCenter;
+    mCentroidRightPos = vec2( mCenter.x * 1.5f, mCenter.y );
+    mCentroidLeftPos = vec2( mCenter.x * 0.5f, mCenter.y );
+}
@@ -0,0 +1,155 @@
+#include "ShapeBatch.h"
+
+#include "cinder/gl/gl.h"
+
+#include <cstddef>
+
+using namespace ci;
+using namespace std;
+
+namespace {
+
+#if defined( CINDER_GL_ES_3 )
+const char *sGlslVersion = "#version 300 es\nprecision highp float;\n";
+#else
+const char *sGlslVersion = "#version 150\n";
+#endif
+
+const char *sVertexShader = R"(
+uniform mat4    ciModelViewProjection;
+
+in vec4         ciPosition;
+in vec4         iCenterHalfSize;
+in vec4         iColor;
+in float        iCornerRadius;
+
+out vec2        vLocal;
+out vec2        vHalfSize;
+out float       vCornerRadius;
+out vec4        vColor;
+
+void main()
+{
+    // pad the quad by one unit so the anti-aliased edge isn't clipped
+    vec2 extent = iCenterHalfSize.zw + vec2( 1.0 );
+    vLocal = ciPosition.xy * extent;
+    vHalfSize = iCenterHalfSize.zw;
+    vCornerRadius = iCornerRadius;
+    vColor = iColor;
+    gl_Position = ciModelViewProjection * vec4( iCenterHalfSize.xy + vLocal, 0.0, 1.0 );
+}
+)";
+
+const char *sFragmentShader = R"(
+in vec2         vLocal;
+in vec2         vHalfSize;
+in float        vCornerRadius;
+in vec4         vColor;
+
+out vec4        oColor;
+
+void main()
+{
+    // signed distance to a rounded box; a circle is a box whose corner radius equals its half size
+    vec2 q = abs( vLocal ) - vHalfSize + vCornerRadius;
+    float dist = length( max( q, 0.0 ) ) + min( max( q.x, q.y ), 0.0 ) - vCornerRadius;
+    float coverage = clamp( 0.5 - dist / max( fwidth( dist ), 0.0001 ), 0.0, 1.0 );
+    oColor = vec4( vColor.rgb, vColor.a * coverage );
+}
+)";
+
+} // anonymous namespace
+
+ShapeBatch::ShapeBatch()
+    : mCapacity( 0 )
+{
+}
+
+void ShapeBatch::addCircle( const vec2 &center, float radius, const ColorA &color )
+{
+    if( radius <= 0 )
+        return;
+
+    addInstance( center, vec2( radius ), radius, color );
+}
+
+void ShapeBatch::addRect( const Rectf &rect, const ColorA &color )
+{
+    addInstance( rect.getCenter(), rect.getSize() / 2.0f, 0, color );
+}
+
+void ShapeBatch::addInstance( const vec2 &center, const vec2 &halfSize, float cornerRadius, const ColorA &color )
+{
+    Instance instance;
+    instance.mCenterHalfSize = vec4( center, halfSize );
+    instance.mColor = vec4( color.r, color.g, color.b, color.a );
+    instance.mCornerRadius = cornerRadius;
+    mInstances.push_back( instance );
+}
+
+void ShapeBatch::allocate( size_t capacity )
+{
+    if( ! mGlsl ) {
+        // programs are shared between the app's GL contexts, so every window's batch uses the same one
+        static weak_ptr<gl::GlslProg> sSharedGlsl;
+        mGlsl = sSharedGlsl.lock();
+        if( ! mGlsl ) {
+            mGlsl = gl::GlslProg::create( gl::GlslProg::Format()
+                                            .vertex( string( sGlslVersion ) + sVertexShader )
+                                            .fragment( string( sGlslVersion ) + sFragmentShader ) );
+            sSharedGlsl = mGlsl;
+        }
+    }
+
+    mCapacity = capacity;
+    mInstanceVbo = gl::Vbo::create( GL_ARRAY_BUFFER, mCapacity * sizeof( Instance ), nullptr, GL_DYNAMIC_DRAW );
+
+    geom::BufferLayout instanceLayout;
+    instanceLayout.append( geom::Attrib::CUSTOM_0, 4, sizeof( Instance ), offsetof( Instance, mCenterHalfSize ), 1 );
+    instanceLayout.append( geom::Attrib::CUSTOM_1, 4, sizeof( Instance ), offsetof( Instance, mColor ), 1 );
+    instanceLayout.append( geom::Attrib::CUSTOM_2, 1, sizeof( Instance ), offsetof( Instance, mCornerRadius ), 1 );
+
+    auto mesh = gl::VboMesh::create( geom::Rect( Rectf( -1, -1, 1, 1 ) ) );
+    mesh->appendVbo( instanceLayout, mInstanceVbo );
+
+    mBatch = gl::Batch::create( mesh, mGlsl, {
+        { geom::Attrib::CUSTOM_0, "iCenterHalfSize" },
+        { geom::Attrib::CUSTOM_1, "iColor" },
+        { geom::Attrib::CUSTOM_2, "iCornerRadius" }
+    } );
+}
+
+void ShapeBatch::draw()
+{
+    if( mInstances.empty() )
+        return;
+
+#if defined( CINDER_GL_ES_2 )
+    // no instancing on ES 2, fall back to one draw per shape
+    for( const auto &instance : mInstances ) {
+        gl::ScopedColor colorScope( instance.mColor.x, instance.mColor.y, instance.mColor.z, instance.mColor.w );
+        vec2 center( instance.mCenterHalfSize.x, instance.mCenterHalfSize.y );
+        vec2 halfSize( instance.mCenterHalfSize.z, instance.mCenterHalfSize.w );
+        if( instance.mCornerRadius > 0 )
+            gl::drawSolidCircle( center, instance.mCornerRadius );
+        else
+            gl::drawSolidRect( Rectf( center - halfSize, center + halfSize ) );
+    }
+#else
+    if( mInstances.size() > mCapacity ) {
+        size_t capacity = max<size_t>( 64, mCapacity );
+        while( capacity < mInstances.size() )
+            capacity *= 2;
+
+        allocate( capacity );
+    }
+
+    // orphan the previous frame's storage so the upload doesn't stall on a draw still in flight
+    mInstanceVbo->bufferData( mCapacity * sizeof( Instance ), nullptr, GL_DYNAMIC_DRAW );
+    mInstanceVbo->bufferSubData( 0, mInstances.size() * sizeof( Instance ), mInstances.data() );
+
+    mBatch->drawInstanced( (GLsizei)mInstances.size() );
+#endif
+
+    mInstances.clear();
+}
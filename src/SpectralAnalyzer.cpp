@@ -0,0 +1,85 @@
+#include "SpectralAnalyzer.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace ci;
+using namespace std;
+
+SpectralAnalyzer::SpectralAnalyzer( const Format &format )
+    : mFormat( format ), mRms( 0 )
+{
+    if( ! mFormat.mWindowSize )
+        mFormat.mWindowSize = mFormat.mFftSize;
+    if( mFormat.mFftSize < mFormat.mWindowSize )
+        mFormat.mFftSize = mFormat.mWindowSize;
+    if( ! audio::dsp::isPowerOf2( mFormat.mFftSize ) )
+        mFormat.mFftSize = audio::dsp::nextPowerOf2( mFormat.mFftSize );
+
+    mFormat.mSmoothingFactor = min( max( mFormat.mSmoothingFactor, 0.0f ), 1.0f );
+
+    mFft.reset( new audio::dsp::Fft( mFormat.mFftSize ) );
+    mWindowingTable.resize( mFormat.mWindowSize );
+    audio::dsp::generateWindow( mFormat.mWindowType, mWindowingTable.data(), mFormat.mWindowSize );
+
+    // the frames past the window stay zero, that is the zero-padding
+    mWindowBuffer = audio::Buffer( mFormat.mFftSize );
+    mWindowBuffer.zero();
+    mSpectralBuffer = audio::BufferSpectral( mFormat.mFftSize );
+    mMagSpectrum.assign( mFormat.mFftSize / 2, 0.0f );
+}
+
+void SpectralAnalyzer::process( const audio::Buffer &buffer )
+{
+    const size_t windowSize = mFormat.mWindowSize;
+    const size_t numFrames = min( windowSize, buffer.getNumFrames() );
+    const size_t offset = buffer.getNumFrames() - numFrames;
+    float *window = mWindowBuffer.getData();
+
+    // most recent frames, mixed down to mono, right-aligned in the window if the buffer is shorter
+    fill( window, window + windowSize, 0.0f );
+    float *dest = window + windowSize - numFrames;
+    const size_t numChannels = buffer.getNumChannels();
+    for( size_t ch = 0; ch < numChannels; ch++ )
+        audio::dsp::add( dest, buffer.getChannel( ch ) + offset, dest, numFrames );
+    if( numChannels > 1 )
+        audio::dsp::mul( dest, 1.0f / (float)numChannels, dest, numFrames );
+
+    analyzeWindow();
+}
+
+void SpectralAnalyzer::process( const float *samples, size_t numFrames )
+{
+    const size_t windowSize = mFormat.mWindowSize;
+    const size_t numCopied = min( windowSize, numFrames );
+    float *window = mWindowBuffer.getData();
+
+    fill( window, window + windowSize - numCopied, 0.0f );
+    copy( samples + numFrames - numCopied, samples + numFrames, window + windowSize - numCopied );
+
+    analyzeWindow();
+}
+
+void SpectralAnalyzer::analyzeWindow()
+{
+    const size_t windowSize = mFormat.mWindowSize;
+    float *window = mWindowBuffer.getData();
+
+    mRms = audio::dsp::rms( window, windowSize );
+
+    audio::dsp::mul( window, mWindowingTable.data(), window, windowSize );
+    mFft->forward( &mWindowBuffer, &mSpectralBuffer );
+
+    const float *real = mSpectralBuffer.getReal();
+    float *imag = mSpectralBuffer.getImag();
+
+    // the packed nyquist component isn't part of the magnitude spectrum
+    imag[0] = 0;
+
+    const float magScale = 1.0f / (float)mFormat.mFftSize;
+    const float smoothing = mFormat.mSmoothingFactor;
+    for( size_t i = 0; i < mMagSpectrum.size(); i++ ) {
+        float mag = sqrt( real[i] * real[i] + imag[i] * imag[i] ) * magScale;
+        mMagSpectrum[i] = mMagSpectrum[i] * smoothing + mag * ( 1 - smoothing );
+    }
+}
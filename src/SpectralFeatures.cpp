@@ -0,0 +1,51 @@
+#include "SpectralFeatures.h"
+
+#include "cinder/audio/Utilities.h"
+
+#include <algorithm>
+
+using namespace ci;
+using namespace std;
+
+SpectralFeatures SpectralFeatures::measure( const SpectralAnalyzer &analyzer, const RateTables &tables, const AnalysisConfig &config )
+{
+    const vector<float> &magSpectrum = analyzer.getMagSpectrum();
+
+    SpectralFeatures features;
+    features.mInputLevel = audio::linearToDecibel( analyzer.getRms() );
+
+    // The spectral centroid is largely correlated with 'brightness' of a sound. It is the center of mass of all frequency values.
+    // It is computed from the same magnitude spectrum that gets published, so the two always agree.
+    float weightedSum = 0, magSum = 0;
+    for( size_t i = 0; i < magSpectrum.size(); i++ ) {
+        weightedSum += magSpectrum[i] * tables.mBinFreqs[i];
+        magSum += magSpectrum[i];
+    }
+    float spectralCentroid = magSum > 0 ? weightedSum / magSum : 0;
+    features.mSpectralCentroid = spectralCentroid;
+
+    // revised variable MyQuisp - .745 ended up being a "sweet spot" but is off by roughly 10-4 hz
+    // ie. low e on guitar is 82hz, reports as 86hz - high e is 322hz, reports as 362hz (or something)
+    // (both this factor and the 1024 below come from the config now, "centroidFactor" and "referenceWidth")
+    float MyQuisp = tables.mCentroidDivisor;
+    float frNormT = spectralCentroid / MyQuisp; // Needed to read freq
+    // locate frequency bin with somewhat better accuracy to measure frequency;
+    // this is purely in analysis coordinates (bins) - the 1024 is the plot width the 0.745 factor was tuned against,
+    // it is part of the estimate and doesn't follow the window size
+    float FBins = min( frNormT * config.mReferenceWidth, (float)magSpectrum.size() - 1 );
+    // snag frequency using location of spectral node (above) as coord for bin#
+    float FCalc = tables.getFreqForBin( FBins );
+    // the estimate is often an octave off, which fires the wrong band - keep whichever of it, half or twice it fits
+    // the harmonics in the spectrum best
+    if( config.mOctaveCorrection ) {
+        FCalc = tables.correctOctave( magSpectrum.data(), FCalc );
+        FBins = min( tables.getBinForFreq( FCalc ), (float)magSpectrum.size() - 1 );
+    }
+    // measure volume mag of bin# (where dominant frequency is located
+    float FVolm = audio::linearToDecibel( magSpectrum[(size_t)FBins] );
+
+    features.mPitchBin = FBins;
+    features.mPitchFreq = FCalc;
+    features.mPitchLevel = FVolm;
+    return features;
+}
@@ -0,0 +1,180 @@
+#include "SpectrumEnvelopePlot.h"
+
+#include "cinder/audio/Utilities.h"
+#include "cinder/gl/gl.h"
+
+#include <algorithm>
+#include <cstddef>
+
+#if defined( __SSE__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 1 )
+    #include <xmmintrin.h>
+    #define SPECTRUM_REDUCE_SSE
+#elif defined( __ARM_NEON ) || defined( __ARM_NEON__ )
+    #include <arm_neon.h>
+    #define SPECTRUM_REDUCE_NEON
+#endif
+
+using namespace ci;
+using namespace std;
+
+namespace {
+
+// min, max and sum of data[0, count) in one pass, four lanes at a time
+inline void reduceRange( const float *data, size_t count, float *resultMin, float *resultMax, float *resultSum )
+{
+    float minVal = data[0];
+    float maxVal = data[0];
+    float sum = 0;
+    size_t i = 0;
+
+#if defined( SPECTRUM_REDUCE_SSE )
+    if( count >= 4 ) {
+        __m128 vmin = _mm_loadu_ps( data );
+        __m128 vmax = vmin;
+        __m128 vsum = _mm_setzero_ps();
+        for( ; i + 4 <= count; i += 4 ) {
+            __m128 v = _mm_loadu_ps( data + i );
+            vmin = _mm_min_ps( vmin, v );
+            vmax = _mm_max_ps( vmax, v );
+            vsum = _mm_add_ps( vsum, v );
+        }
+
+        alignas( 16 ) float lanes[12];
+        _mm_store_ps( lanes, vmin );
+        _mm_store_ps( lanes + 4, vmax );
+        _mm_store_ps( lanes + 8, vsum );
+        minVal = min( min( lanes[0], lanes[1] ), min( lanes[2], lanes[3] ) );
+        maxVal = max( max( lanes[4], lanes[5] ), max( lanes[6], lanes[7] ) );
+        sum = lanes[8] + lanes[9] + lanes[10] + lanes[11];
+    }
+#elif defined( SPECTRUM_REDUCE_NEON )
+    if( count >= 4 ) {
+        float32x4_t vmin = vld1q_f32( data );
+        float32x4_t vmax = vmin;
+        float32x4_t vsum = vdupq_n_f32( 0 );
+        for( ; i + 4 <= count; i += 4 ) {
+            float32x4_t v = vld1q_f32( data + i );
+            vmin = vminq_f32( vmin, v );
+            vmax = vmaxq_f32( vmax, v );
+            vsum = vaddq_f32( vsum, v );
+        }
+
+        float lanes[12];
+        vst1q_f32( lanes, vmin );
+        vst1q_f32( lanes + 4, vmax );
+        vst1q_f32( lanes + 8, vsum );
+        minVal = min( min( lanes[0], lanes[1] ), min( lanes[2], lanes[3] ) );
+        maxVal = max( max( lanes[4], lanes[5] ), max( lanes[6], lanes[7] ) );
+        sum = lanes[8] + lanes[9] + lanes[10] + lanes[11];
+    }
+#endif
+
+    for( ; i < count; i++ ) {
+        minVal = min( minVal, data[i] );
+        maxVal = max( maxVal, data[i] );
+        sum += data[i];
+    }
+
+    *resultMin = minVal;
+    *resultMax = maxVal;
+    *resultSum = sum;
+}
+
+// normalized decibels (0 - 1), as SpectrumPlot draws them
+inline float toPlotMagnitude( float linear )
+{
+    return min( 1.0f, audio::linearToDecibel( linear ) / 100 );
+}
+
+} // anonymous namespace
+
+void reduceSpectrum( const float *magSpectrum, const FrequencyAxis &axis, SpectrumEnvelope *result )
+{
+    size_t numColumns = axis.getNumColumns();
+    result->mMin.resize( numColumns );
+    result->mMax.resize( numColumns );
+    result->mMean.resize( numColumns );
+
+    const uint32_t *columnBegin = axis.getColumnBegin();
+    const uint32_t *columnEnd = axis.getColumnEnd();
+    for( size_t col = 0; col < numColumns; col++ ) {
+        size_t count = columnEnd[col] - columnBegin[col];
+        float sum;
+        reduceRange( magSpectrum + columnBegin[col], count, &result->mMin[col], &result->mMax[col], &sum );
+        result->mMean[col] = sum / (float)count;
+    }
+}
+
+SpectrumEnvelopePlot::SpectrumEnvelopePlot()
+    : mBorderEnabled( true ), mBorderColor( 0.5f, 0.5f, 0.5f, 1 ), mScale( FrequencyAxis::Scale::LINEAR ), mNumColumns( 0 )
+{
+}
+
+void SpectrumEnvelopePlot::allocate( size_t numColumns )
+{
+    mNumColumns = numColumns;
+    mVertices.resize( numColumns * 5 );
+    mVbo = gl::Vbo::create( GL_ARRAY_BUFFER, mVertices.size() * sizeof( Vertex ), nullptr, GL_DYNAMIC_DRAW );
+
+    // three meshes over ranges of the one buffer
+    auto glsl = gl::getStockShader( gl::ShaderDef().color() );
+    auto createBatch = [&]( size_t first, size_t count, GLenum primitive ) {
+        geom::BufferLayout layout;
+        layout.append( geom::Attrib::POSITION, 2, sizeof( Vertex ), first * sizeof( Vertex ) + offsetof( Vertex, mPosition ) );
+        layout.append( geom::Attrib::COLOR, 4, sizeof( Vertex ), first * sizeof( Vertex ) + offsetof( Vertex, mColor ) );
+        return gl::Batch::create( gl::VboMesh::create( (uint32_t)count, primitive, { { layout, mVbo } } ), glsl );
+    };
+
+    mFillBatch = createBatch( 0, numColumns * 2, GL_TRIANGLE_STRIP );
+    mBandBatch = createBatch( numColumns * 2, numColumns * 2, GL_TRIANGLE_STRIP );
+    mMeanBatch = createBatch( numColumns * 4, numColumns, GL_LINE_STRIP );
+}
+
+void SpectrumEnvelopePlot::draw( const vector<float> &magSpectrum, float nyquist )
+{
+    if( magSpectrum.empty() )
+        return;
+
+    // the bin -> column table only changes with the layout, FFT size or scale
+    mAxis.setup( magSpectrum.size(), (size_t)max( 1.0f, mBounds.getWidth() ), nyquist, mScale );
+    reduceSpectrum( magSpectrum.data(), mAxis, &mEnvelope );
+
+    const size_t numColumns = mAxis.getNumColumns();
+    if( numColumns != mNumColumns )
+        allocate( numColumns );
+
+    const vec4 bottomColor( 0, 0, 1, 1 );
+    const float height = mBounds.getHeight();
+
+    // filled up to the quietest bin in each column, translucent band up to the loudest, mean on top
+    Vertex *fill = mVertices.data();
+    Vertex *band = fill + numColumns * 2;
+    Vertex *mean = band + numColumns * 2;
+    for( size_t col = 0; col < numColumns; col++ ) {
+        float x = mBounds.x1 + (float)col;
+        float lo = toPlotMagnitude( mEnvelope.mMin[col] );
+        float hi = toPlotMagnitude( mEnvelope.mMax[col] );
+        float avg = toPlotMagnitude( mEnvelope.mMean[col] );
+
+        *fill++ = { vec2( x, mBounds.y2 ), bottomColor };
+        *fill++ = { vec2( x, mBounds.y2 - lo * height ), vec4( 0, lo, 0.7f, 1 ) };
+
+        *band++ = { vec2( x, mBounds.y2 - lo * height ), vec4( 0, lo, 0.7f, 0.5f ) };
+        *band++ = { vec2( x, mBounds.y2 - hi * height ), vec4( 0, hi, 0.7f, 0.5f ) };
+
+        *mean++ = { vec2( x, mBounds.y2 - avg * height ), vec4( 0, 0.9f, 0.9f, 1 ) };
+    }
+
+    // orphan the previous frame's storage so the upload doesn't stall on a draw still in flight
+    mVbo->bufferData( mVertices.size() * sizeof( Vertex ), nullptr, GL_DYNAMIC_DRAW );
+    mVbo->bufferSubData( 0, mVertices.size() * sizeof( Vertex ), mVertices.data() );
+
+    mFillBatch->draw();
+    mBandBatch->draw();
+    mMeanBatch->draw();
+
+    if( mBorderEnabled ) {
+        gl::color( mBorderColor );
+        gl::drawStrokedRect( mBounds );
+    }
+}
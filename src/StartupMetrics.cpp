@@ -0,0 +1,61 @@
+#include "StartupMetrics.h"
+
+#include <chrono>
+#include <cstdio>
+
+using namespace std;
+
+namespace {
+
+// initialized with the other statics, before main() runs
+const chrono::steady_clock::time_point sLaunchTime = chrono::steady_clock::now();
+
+} // anonymous namespace
+
+StartupMetrics& StartupMetrics::instance()
+{
+    static StartupMetrics sInstance;
+    return sInstance;
+}
+
+void StartupMetrics::mark( const string &milestone )
+{
+    double ms = chrono::duration<double, milli>( chrono::steady_clock::now() - sLaunchTime ).count();
+
+    lock_guard<mutex> lock( mMutex );
+    for( const auto &m : mMarks ) {
+        if( m.first == milestone )
+            return;
+    }
+
+    mMarks.emplace_back( milestone, ms );
+}
+
+bool StartupMetrics::hasMark( const string &milestone ) const
+{
+    return getMilliseconds( milestone ) >= 0;
+}
+
+double StartupMetrics::getMilliseconds( const string &milestone ) const
+{
+    lock_guard<mutex> lock( mMutex );
+    for( const auto &m : mMarks ) {
+        if( m.first == milestone )
+            return m.second;
+    }
+
+    return -1;
+}
+
+string StartupMetrics::format() const
+{
+    lock_guard<mutex> lock( mMutex );
+    string result = "startup:";
+    for( const auto &m : mMarks ) {
+        char value[32];
+        snprintf( value, sizeof( value ), "=%.1fms", m.second );
+        result += " " + m.first + value;
+    }
+
+    return result;
+}
@@ -0,0 +1,112 @@
+#include "ThreadPolicy.h"
+
+#include <cstring>
+
+#if defined( _WIN32 )
+    #include <windows.h>
+#else
+    #include <cerrno>
+    #include <pthread.h>
+    #include <sched.h>
+#endif
+
+using namespace std;
+
+namespace {
+
+string describeError( int error )
+{
+    if( error == ThreadPolicyResult::kUnsupported )
+        return "not supported on this platform";
+
+#if defined( _WIN32 )
+    // GetLastError() codes, which strerror() would misread as errno values
+    char message[256];
+    DWORD length = FormatMessageA( FORMAT_MESSAGE_FROM_SYSTEM | FORMAT_MESSAGE_IGNORE_INSERTS, nullptr, (DWORD)error, 0, message, sizeof( message ), nullptr );
+    while( length && ( message[length - 1] == '\n' || message[length - 1] == '\r' || message[length - 1] == '.' ) )
+        length--;
+
+    return length ? string( message, length ) : "error " + to_string( error );
+#else
+    return strerror( error );
+#endif
+}
+
+ThreadPolicyResult applyPolicy( const ThreadPolicy &policy, bool realtime )
+{
+    ThreadPolicyResult result;
+    result.mRealtimeRequested = realtime;
+    result.mAffinityRequested = ! policy.mCpus.empty();
+
+#if defined( _WIN32 )
+    if( realtime ) {
+        if( ! SetThreadPriority( GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL ) )
+            result.mRealtimeError = (int)GetLastError();
+    }
+
+    if( ! policy.mCpus.empty() ) {
+        DWORD_PTR mask = 0;
+        for( int cpu : policy.mCpus )
+            mask |= (DWORD_PTR)1 << cpu;
+        if( ! SetThreadAffinityMask( GetCurrentThread(), mask ) )
+            result.mAffinityError = (int)GetLastError();
+    }
+#else
+    if( realtime ) {
+        // without the privilege (CAP_SYS_NICE / rtprio limit on Linux) this fails with EPERM and the thread stays as it was
+        sched_param param;
+        memset( &param, 0, sizeof( param ) );
+        param.sched_priority = policy.mPriority > 0 ? policy.mPriority : sched_get_priority_max( SCHED_FIFO ) / 2;
+        result.mRealtimeError = pthread_setschedparam( pthread_self(), SCHED_FIFO, &param );
+    }
+
+    if( ! policy.mCpus.empty() ) {
+    #if defined( __linux__ ) && ! defined( __ANDROID__ )
+        cpu_set_t cpus;
+        CPU_ZERO( &cpus );
+        for( int cpu : policy.mCpus )
+            CPU_SET( cpu, &cpus );
+        result.mAffinityError = pthread_setaffinity_np( pthread_self(), sizeof( cpus ), &cpus );
+    #else
+        // macOS only has affinity hints and Android restricts it, neither pins a thread
+        result.mAffinityError = ThreadPolicyResult::kUnsupported;
+    #endif
+    }
+#endif
+
+    return result;
+}
+
+} // anonymous namespace
+
+string ThreadPolicyResult::describe() const
+{
+    auto describePart = []( const string &name, bool requested, int error ) {
+        if( ! requested )
+            return name + " not requested";
+        return error ? name + " denied (" + describeError( error ) + ")" : name + " ok";
+    };
+
+    return describePart( "realtime", mRealtimeRequested, mRealtimeError ) + ", " + describePart( "affinity", mAffinityRequested, mAffinityError );
+}
+
+ThreadPolicyResult applyThreadPolicy( const ThreadPolicy &policy )
+{
+    return applyPolicy( policy, policy.mRealtime );
+}
+
+ThreadPolicyResult applyAudioThreadPolicy( const ThreadPolicy &policy )
+{
+#if defined( __APPLE__ )
+    // CoreAudio's IO thread already runs under a time constraint policy, SCHED_FIFO would replace it with a weaker one
+    ThreadPolicyResult result = applyPolicy( policy, false );
+    if( policy.mRealtime ) {
+        result.mRealtimeRequested = true;
+        result.mRealtimeError = ThreadPolicyResult::kUnsupported;
+    }
+
+    return result;
+#else
+    return applyThreadPolicy( policy );
+#endif
+}
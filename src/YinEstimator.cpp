@@ -0,0 +1,66 @@
+#include "YinEstimator.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+YinEstimator::YinEstimator( float threshold )
+    : mThreshold( threshold )
+{
+}
+
+PitchEstimate YinEstimator::estimate( const float *samples, size_t numSamples, float sampleRate, size_t minLag, size_t maxLag )
+{
+    if( minLag < 2 || maxLag <= minLag || numSamples <= maxLag * 2 )
+        return PitchEstimate();
+
+    // integration window, the lags (up to maxLag + 1 for the interpolation) slide over the rest
+    const size_t window = numSamples - maxLag - 1;
+
+    float energy = 0;
+    for( size_t j = 0; j < window; j++ )
+        energy += samples[j] * samples[j];
+    if( energy < 1e-8f * (float)window )
+        return PitchEstimate();
+
+    // difference function, normalized by its running mean as it goes
+    mDifference.resize( maxLag + 2 );
+    mDifference[0] = 1;
+    float runningSum = 0;
+    for( size_t lag = 1; lag <= maxLag + 1; lag++ ) {
+        const float *shifted = samples + lag;
+        float sum = 0;
+        for( size_t j = 0; j < window; j++ ) {
+            float delta = samples[j] - shifted[j];
+            sum += delta * delta;
+        }
+
+        runningSum += sum;
+        mDifference[lag] = runningSum > 0 ? sum * (float)lag / runningSum : 1;
+    }
+
+    // first dip below the threshold, followed down to its minimum; the global minimum if none dips that low
+    size_t period = 0;
+    for( size_t lag = minLag; lag <= maxLag; lag++ ) {
+        if( mDifference[lag] < mThreshold ) {
+            while( lag + 1 <= maxLag && mDifference[lag + 1] < mDifference[lag] )
+                lag++;
+            period = lag;
+            break;
+        }
+    }
+
+    if( ! period )
+        period = (size_t)( min_element( mDifference.begin() + minLag, mDifference.begin() + maxLag + 1 ) - mDifference.begin() );
+
+    // parabolic interpolation between the neighbouring lags
+    float refined = (float)period;
+    float prev = mDifference[period - 1], current = mDifference[period], next = mDifference[period + 1];
+    float denominator = prev - 2 * current + next;
+    if( denominator > 0 )
+        refined += 0.5f * ( prev - next ) / denominator;
+
+    float confidence = max( 0.0f, 1 - current );
+    return PitchEstimate( sampleRate / refined, confidence );
+}